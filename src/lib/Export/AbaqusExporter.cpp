@@ -10,8 +10,8 @@
 namespace voxel2tet
 {
 
-AbaqusExporter::AbaqusExporter(std :: vector< TriangleType * > *Triangles, std :: vector< VertexType * > *Vertices, std :: vector< EdgeType * > *Edges, std :: vector< TetType * > *Tets) :
-    Exporter(Triangles, Vertices, Edges, Tets)
+AbaqusExporter::AbaqusExporter(MeshSnapshot *Snapshot) :
+    Exporter(Snapshot)
 {
 
 }
@@ -51,19 +51,20 @@ void AbaqusExporter::WriteVolumeData(std :: string Filename)
     AbaqusFile.precision(10);
 
     // Write vertices/nodes
-    for ( size_t i = 0; i < this->Vertices->size(); i++ ) {
-        AbaqusFile << i + 1 << ",\t" << UsedVertices.at(i)->get_c(0) << ",\t" \
-                  << UsedVertices.at(i)->get_c(1) << ",\t" << UsedVertices.at(i)->get_c(2) << "\n";
+    for ( size_t i = 0; i < UsedVertices.size(); i++ ) {
+        AbaqusFile << i + 1 << ",\t" << Snapshot->GiveCoordinate(UsedVertices [ i ], 0) << ",\t" \
+                  << Snapshot->GiveCoordinate(UsedVertices [ i ], 1) << ",\t" << Snapshot->GiveCoordinate(UsedVertices [ i ], 2) << "\n";
     }
 
     AbaqusFile << "**\n** SOLID ELEMENTS\n**\n";
     for (auto a: Self2OofemMaterials) {
         AbaqusFile << "*ELEMENT, TYPE=C3D4, ELSET=SOLID_" << a.first << "\n";
-        for (TetType *t: *this->Tets) {
-            if (t->MaterialID == a.first) {
-                AbaqusFile << "  " << t->ID+1 << ",\t" << t->Vertices[0]->tag+1 << ",\t" <<
-                              t->Vertices[1]->tag+1 << ",\t" << t->Vertices[2]->tag+1 <<
-                              ",\t" << t->Vertices[3]->tag+1 << "\n";
+        for (size_t t = 0; t < Snapshot->GiveNumberOfTets(); t++) {
+            if (Snapshot->TetMaterialIDs[t] == a.first) {
+                const int *tv = &Snapshot->TetVertices[4*t];
+                AbaqusFile << "  " << Snapshot->TetIDs[t]+1 << ",\t" << Snapshot->VolumeVertexIndex[tv[0]]+1 << ",\t" <<
+                              Snapshot->VolumeVertexIndex[tv[1]]+1 << ",\t" << Snapshot->VolumeVertexIndex[tv[2]]+1 <<
+                              ",\t" << Snapshot->VolumeVertexIndex[tv[3]]+1 << "\n";
             }
         }
         LOG("%u\n", a.first);
@@ -90,7 +91,7 @@ void AbaqusExporter::WriteVolumeData(std :: string Filename)
     for ( size_t i = 0; i < 3; i++ ) {
         // Write max nodes
         for ( size_t j = 0; j < MaxNodes [ i ].size(); j++ ) {
-            AbaqusFile << "\t" << MaxNodes [ i ].at(j)->tag + 1 << ",";
+            AbaqusFile << "\t" << MaxNodes [ i ].at(j) + 1 << ",";
             if (k==10) {
                 AbaqusFile << "\n";
                 k=0;
@@ -101,7 +102,7 @@ void AbaqusExporter::WriteVolumeData(std :: string Filename)
 
         // Write min nodes
         for ( size_t j = 0; j < MinNodes [ i ].size(); j++ ) {
-            AbaqusFile << "\t" << MinNodes [ i ].at(j)->tag + 1 << ",";
+            AbaqusFile << "\t" << MinNodes [ i ].at(j) + 1 << ",";
             if (k==10) {
                 AbaqusFile << "\n";
                 k=0;
@@ -122,7 +123,7 @@ void AbaqusExporter::WriteVolumeData(std :: string Filename)
         // Write max nodes
         AbaqusFile << "*NSET, NSET=" << MaxNames [ i ] << "\n";
         for ( size_t j = 0; j < MaxNodes [ i ].size(); j++ ) {
-            AbaqusFile << "\t" << MaxNodes [ i ].at(j)->tag + 1;
+            AbaqusFile << "\t" << MaxNodes [ i ].at(j) + 1;
             if (j!=MaxNodes[i].size()-1) { AbaqusFile << ","; }
             if (k==10) {
                 AbaqusFile << "\n";
@@ -137,7 +138,7 @@ void AbaqusExporter::WriteVolumeData(std :: string Filename)
         k=0;
         AbaqusFile << "*NSET, NSET=" << MinNames [ i ] << "\n";
         for ( size_t j = 0; j < MinNodes [ i ].size(); j++ ) {
-            AbaqusFile << "\t" << MinNodes [ i ].at(j)->tag + 1;
+            AbaqusFile << "\t" << MinNodes [ i ].at(j) + 1;
             if (j!=MinNodes[i].size()-1) { AbaqusFile << ","; }
             if (k==10) {
                 AbaqusFile << "\n";
@@ -163,11 +164,11 @@ void AbaqusExporter::WriteVolumeData(std :: string Filename)
     AbaqusFile << "** Complete boundary by element sides\n";
     AbaqusFile << "*SURFACE, NAME=AllSurfaces, TYPE=ELEMENT\n";
     for ( int k = 0; k < 2; k++ ) {
-        std :: array< std :: vector< TetType * >, 3 > *Elements = ( k == 0 ) ? & MaxElements : & MinElements;
+        std :: array< std :: vector< int >, 3 > *Elements = ( k == 0 ) ? & MaxElements : & MinElements;
         std :: array< std :: vector< int >, 3 > *Sides = ( k == 0 ) ? & MaxSide : & MinSide;
         for ( int i = 0; i < 3; i++ ) {
             for ( size_t j = 0; j < Elements->at(i).size(); j++ ) {
-                AbaqusFile << " " << Elements->at(i).at(j)->ID + 1 << ", S" << Sides->at(i).at(j) << "\n";
+                AbaqusFile << " " << Snapshot->TetIDs [ Elements->at(i).at(j) ] + 1 << ", S" << Sides->at(i).at(j) << "\n";
             }
         }
     }
@@ -176,13 +177,13 @@ void AbaqusExporter::WriteVolumeData(std :: string Filename)
     // Boundaries in all directions
     for ( int k = 0; k < 2; k++ ) {
         std :: array< std :: string, 3 > *Comments = ( k == 0 ) ? & MaxNames : & MinNames;
-        std :: array< std :: vector< TetType * >, 3 > *Elements = ( k == 0 ) ? & MaxElements : & MinElements;
+        std :: array< std :: vector< int >, 3 > *Elements = ( k == 0 ) ? & MaxElements : & MinElements;
         std :: array< std :: vector< int >, 3 > *Sides = ( k == 0 ) ? & MaxSide : & MinSide;
 
         for ( int i = 0; i < 3; i++ ) {
             AbaqusFile << "*SURFACE, NAME=Surface" << Comments->at(i) << "\n";
             for ( size_t j = 0; j < Elements->at(i).size(); j++ ) {
-                AbaqusFile << "\t" << Elements->at(i).at(j)->ID + 1 << ", S" << Sides->at(i).at(j) << "\n";
+                AbaqusFile << "\t" << Snapshot->TetIDs [ Elements->at(i).at(j) ] + 1 << ", S" << Sides->at(i).at(j) << "\n";
             }
             AbaqusFile << "\n";
         }
@@ -9,7 +9,7 @@ namespace voxel2tet
 class AbaqusExporter : public Exporter
 {
 public:
-    AbaqusExporter(std :: vector< TriangleType * > *Triangles, std :: vector< VertexType * > *Vertices, std :: vector< EdgeType * > *Edges, std :: vector< TetType * > *Tets);
+    AbaqusExporter(MeshSnapshot *Snapshot);
     virtual void WriteSurfaceData(std :: string Filename) {}
     virtual void WriteVolumeData(std :: string Filename);
 };
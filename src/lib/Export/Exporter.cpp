@@ -9,58 +9,41 @@
 namespace voxel2tet
 {
 
-Exporter :: Exporter(std :: vector< TriangleType * > *Triangles, std :: vector< VertexType * > *Vertices, std :: vector< EdgeType * > *Edges, std :: vector< TetType * > *Tets)
+Exporter :: Exporter(MeshSnapshot *Snapshot)
 {
-    LOG("Create exporter for MeshData@%p\n", Triangles);
-    this->Vertices = Vertices;
-    this->Edges = Edges;
-    this->Triangles = Triangles;
-    this->Tets = Tets;
+    LOG("Create exporter for MeshSnapshot@%p\n", Snapshot);
+    this->Snapshot = Snapshot;
 }
 
 void Exporter::UpdateUsedVertices()
 {
-
-    UsedVertices.clear();
-
-    for ( TetType *t : *this->Tets ) {
-        for ( VertexType *v : t->Vertices ) {
-            UsedVertices.push_back(v);
-        }
-    }
-
-    std :: sort( UsedVertices.begin(), UsedVertices.end() );
-    UsedVertices.erase( std :: unique( UsedVertices.begin(), UsedVertices.end() ), UsedVertices.end() );
-
-
-    int i = 0;
-    for ( VertexType *v : UsedVertices ) {
-        v->tag = i;
-        i++;
-    }
+    // The snapshot already holds the vertices used by the tetrahedrons in increasing order
+    UsedVertices = Snapshot->VolumeVertices;
 }
 
 void Exporter::UpdateMaterialsMapping()
 {
-    for ( TetType *t : *this->Tets ) {
-        if ( Self2OofemMaterials.find(t->MaterialID) == Self2OofemMaterials.end() ) {
-            Self2OofemMaterials [ t->MaterialID ] = Self2OofemMaterials.size();
+    for ( int MaterialID : Snapshot->TetMaterialIDs ) {
+        if ( Self2OofemMaterials.find(MaterialID) == Self2OofemMaterials.end() ) {
+            Self2OofemMaterials [ MaterialID ] = Self2OofemMaterials.size();
         }
     }
 }
 
 void Exporter::UpdateMinMaxCoordinates()
 {
-    MaxCoords = { { UsedVertices [ 0 ]->get_c(0), UsedVertices [ 0 ]->get_c(1), UsedVertices [ 0 ]->get_c(2) } };
-    MinCoords = { { UsedVertices [ 0 ]->get_c(0), UsedVertices [ 0 ]->get_c(1), UsedVertices [ 0 ]->get_c(2) } };
+    int v0 = UsedVertices [ 0 ];
+    MaxCoords = { { Snapshot->GiveCoordinate(v0, 0), Snapshot->GiveCoordinate(v0, 1), Snapshot->GiveCoordinate(v0, 2) } };
+    MinCoords = MaxCoords;
 
-    for ( VertexType *v : UsedVertices ) {
+    for ( int v : UsedVertices ) {
         for ( size_t i = 0; i < 3; i++ ) {
-            if ( v->get_c(i) > MaxCoords [ i ] ) {
-                MaxCoords [ i ] = v->get_c(i);
+            double cvalue = Snapshot->GiveCoordinate(v, i);
+            if ( cvalue > MaxCoords [ i ] ) {
+                MaxCoords [ i ] = cvalue;
             }
-            if ( v->get_c(i) < MinCoords [ i ] ) {
-                MinCoords [ i ] = v->get_c(i);
+            if ( cvalue < MinCoords [ i ] ) {
+                MinCoords [ i ] = cvalue;
             }
         }
     }
@@ -71,14 +54,14 @@ void Exporter::UpdateMinMaxNodes()
 {
     double eps = 1e-8;
 
-    for ( VertexType *v : UsedVertices ) {
+    for ( size_t n = 0; n < UsedVertices.size(); n++ ) {
         for ( int i = 0; i < 3; i++ ) {
-            double cvalue = v->get_c(i);
+            double cvalue = Snapshot->GiveCoordinate(UsedVertices [ n ], i);
             if ( fabs(cvalue - MaxCoords [ i ]) < eps ) {
-                MaxNodes [ i ].push_back(v);
+                MaxNodes [ i ].push_back(n);
             }
             if ( fabs(cvalue - MinCoords [ i ]) < eps ) {
-                MinNodes [ i ].push_back(v);
+                MinNodes [ i ].push_back(n);
             }
         }
     }
@@ -88,16 +71,15 @@ void Exporter::UpdateMinMaxElements()
 {
     // Find element boundaries
 
-    for ( TetType *t : *this->Tets ) {
+    for ( size_t t = 0; t < Snapshot->GiveNumberOfTets(); t++ ) {
         for ( int k = 0; k < 2; k++ ) {   // Test max/min
-            std :: array< std :: vector< TetType * >, 3 > *XElements = ( k == 0 ) ? & MaxElements : & MinElements;
+            std :: array< std :: vector< int >, 3 > *XElements = ( k == 0 ) ? & MaxElements : & MinElements;
             std :: array< std :: vector< int >, 3 > *XSide = ( k == 0 ) ? & MaxSide : & MinSide;
             for ( int i = 0; i < 3; i++ ) {   // Test direction
                 std :: vector< int >TheNodes;
 
                 for ( int j = 0; j < 4; j++ ) {   // Test node
-                    VertexType *v = t->Vertices [ j ];
-                    double cvalue = v->get_c(i);
+                    double cvalue = Snapshot->GiveCoordinate(Snapshot->TetVertices [ 4 * t + j ], i);
                     if (k==0) {
                         if ( fabs(cvalue - MaxCoords [ i ]) < 1e-8 ) {
                             TheNodes.push_back(j + 1);                                 // +1 to match the numbering in the elemenent manual
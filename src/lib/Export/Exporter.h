@@ -6,6 +6,7 @@
 #include <map>
 
 #include "MeshComponents.h"
+#include "MeshSnapshot.h"
 #include "MiscFunctions.h"
 
 namespace voxel2tet
@@ -18,7 +19,11 @@ enum Exporter_FileTypes { FT_VTK, FT_Poly, FT_OFF, FT_OOFEM, FT_SIMPLE, FT_ABAQU
 class Exporter
 {
 protected:
-    std::vector<VertexType *> UsedVertices;
+    /**
+     * @brief Indices of the vertices used by the tetrahedrons. Node i in the exported file is vertex UsedVertices[i-1]
+     * in the snapshot. For vertex index v, the node number is given by Snapshot->VolumeVertexIndex[v]+1.
+     */
+    std :: vector< int >UsedVertices;
     void UpdateUsedVertices();
 
     std :: map< int, int >Self2OofemMaterials;
@@ -28,48 +33,31 @@ protected:
     std :: array< double, 3 >MinCoords;
     void UpdateMinMaxCoordinates();
 
-    std :: array< std :: vector< VertexType * >, 3 >MaxNodes;
-    std :: array< std :: vector< VertexType * >, 3 >MinNodes;
+    // Zero-based node numbers of the nodes on the boundaries in each direction
+    std :: array< std :: vector< int >, 3 >MaxNodes;
+    std :: array< std :: vector< int >, 3 >MinNodes;
     void UpdateMinMaxNodes();
 
-    std :: array< std :: vector< TetType * >, 3 >MaxElements;
+    // Indices of the tetrahedrons on the boundaries in each direction
+    std :: array< std :: vector< int >, 3 >MaxElements;
     std :: array< std :: vector< int >, 3 >MaxSide;
-    std :: array< std :: vector< TetType * >, 3 >MinElements;
+    std :: array< std :: vector< int >, 3 >MinElements;
     std :: array< std :: vector< int >, 3 >MinSide;
     void UpdateMinMaxElements();
 
     /**
-     * @brief Pointer to a list of pointers to the triangles in the mesh. This is typically a pointer to the list of triangles
-     * in the MeshData object.
-     */
-    std :: vector< TriangleType * > *Triangles;
-
-    /**
-     * @brief Pointer to a list of pointers to the vertices in the mesh. This is typically a pointer to the list of vertices
-     * in the MeshData object.
-     */
-    std :: vector< VertexType * > *Vertices;
-
-    /**
-     * @brief Pointer to a list of pointers to the edges in the mesh. This is typically a pointer to the list of edges
-     * in the MeshData object.
-     */
-    std :: vector< EdgeType * > *Edges;
-
-    /**
-     * @brief Pointer to a list of pointers to the tetrahedrons in the mesh. This is typically a pointer to the list of tetrahedrons
-     * in the MeshData object.
+     * @brief Pointer to a flat copy of the mesh. The exporter never modifies the snapshot nor the mesh it was created from,
+     * thus several exporters can share the same snapshot.
      */
-    std :: vector< TetType * > *Tets;
+    MeshSnapshot *Snapshot;
 public:
     /**
-     * @brief Constructor of the class given lists of neccessary elements.
-     * @param Triangles Pointer to a list of triangles
-     * @param Vertices Pointer to a list of vertices
-     * @param Edges Pointer to a list of edges
-     * @param Tets Pointer to a list of tetrahedrons
+     * @brief Constructor of the class given a snapshot of the mesh.
+     * @param Snapshot Pointer to snapshot of mesh
      */
-    Exporter(std :: vector< TriangleType * > *Triangles, std :: vector< VertexType * > *Vertices, std :: vector< EdgeType * > *Edges, std :: vector< TetType * > *Tets);
+    Exporter(MeshSnapshot *Snapshot);
+
+    virtual ~Exporter() {}
 
     /**
      * @brief Exports a surface mesh. I.e. interfaces between different material IDs. Tetrahedrons will be ignored.
@@ -7,8 +7,8 @@
 namespace voxel2tet
 {
 
-OFFExporter :: OFFExporter(std :: vector< TriangleType * > *Triangles, std :: vector< VertexType * > *Vertices, std :: vector< EdgeType * > *Edges, std :: vector< TetType * > *Tets) :
-    Exporter(Triangles, Vertices, Edges, Tets)
+OFFExporter :: OFFExporter(MeshSnapshot *Snapshot) :
+    Exporter(Snapshot)
 {
     LOG("Create OFFExporter object\n", 0);
 }
@@ -19,43 +19,21 @@ void OFFExporter :: WriteSurfaceData(std :: string Filename)
     std :: ofstream OFFFile;
     OFFFile.open(Filename);
 
-    // Prepare information
-    std :: vector< VertexType * >UsedVertices;
-    for ( TriangleType *t : *this->Triangles ) {
-        for ( VertexType *v : t->Vertices ) {
-            UsedVertices.push_back(v);
-        }
-    }
-
-    std :: sort( UsedVertices.begin(), UsedVertices.end() );
-    UsedVertices.erase( std :: unique( UsedVertices.begin(), UsedVertices.end() ), UsedVertices.end() );
-
-    int i = 0;
-    for ( VertexType *v : UsedVertices ) {
-        v->tag = i;
-        i++;
-    }
-
     // Write header
-    OFFFile << "OFF\n" << UsedVertices.size() << "\t" << this->Triangles->size() << "\t0\n";
+    OFFFile << "OFF\n" << Snapshot->SurfaceVertices.size() << "\t" << Snapshot->GiveNumberOfTriangles() << "\t0\n";
 
     // Write vertices
-    for ( auto v : UsedVertices ) {
-        OFFFile << std :: setiosflags(std :: ios :: fixed) << std :: setprecision(15) << v->get_c(0) << " " << v->get_c(1) << " " << v->get_c(2) << "\n";
+    for ( int v : Snapshot->SurfaceVertices ) {
+        OFFFile << std :: setiosflags(std :: ios :: fixed) << std :: setprecision(15) << Snapshot->GiveCoordinate(v, 0) << " " << Snapshot->GiveCoordinate(v, 1) << " " << Snapshot->GiveCoordinate(v, 2) << "\n";
     }
 
     // Write facets
-    int j = 0;
-
-    for ( auto t : *this->Triangles ) {
+    for ( size_t j = 0; j < Snapshot->GiveNumberOfTriangles(); j++ ) {
         OFFFile << 3;
-        std :: array< int, 3 >VertexIDs;
         for ( int i = 0; i < 3; i++ ) {
-            VertexIDs [ i ] = t->Vertices [ i ]->tag;
-            OFFFile << " " << VertexIDs [ i ];
+            OFFFile << " " << Snapshot->SurfaceVertexIndex [ Snapshot->TriangleVertices [ 3 * j + i ] ];
         }
         OFFFile << "\t#" << j << "\n";
-        j++;
     }
 }
 }
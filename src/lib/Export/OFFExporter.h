@@ -21,7 +21,7 @@ public:
     /**
      * @copydoc Exporter::Exporter
      */
-    OFFExporter(std :: vector< TriangleType * > *Triangles, std :: vector< VertexType * > *Vertices, std :: vector< EdgeType * > *Edges, std :: vector< TetType * > *Tets);
+    OFFExporter(MeshSnapshot *Snapshot);
     virtual void WriteSurfaceData(std :: string Filename);
     virtual void WriteVolumeData(std :: string Filename) {}
 };
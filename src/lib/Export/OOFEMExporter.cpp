@@ -9,8 +9,8 @@
 namespace voxel2tet
 {
 
-OOFEMExporter :: OOFEMExporter(std :: vector< TriangleType * > *Triangles, std :: vector< VertexType * > *Vertices, std :: vector< EdgeType * > *Edges, std :: vector< TetType * > *Tets) :
-    Exporter(Triangles, Vertices, Edges, Tets)
+OOFEMExporter :: OOFEMExporter(MeshSnapshot *Snapshot) :
+    Exporter(Snapshot)
 {
     LOG("Create OOFEMExporter object\n", 0);
 }
@@ -47,23 +47,24 @@ void OOFEMExporter :: WriteVolumeData(std :: string Filename)
     OOFEMFile << "vtkxml tstep_all domain_all domain_all primvars 1 1 cellvars 1 1 \n";
     OOFEMFile << "domain 3d\n";
     OOFEMFile << "OutputManager tstep_all dofman_all element_all\n";
-    OOFEMFile << "ndofman " << UsedVertices.size() << " nelem " << this->Tets->size() << " ncrosssect 1 nmat " \
+    OOFEMFile << "ndofman " << UsedVertices.size() << " nelem " << Snapshot->GiveNumberOfTets() << " ncrosssect 1 nmat " \
               << Self2OofemMaterials.size() << " nbc 1 nic 1 nltf 1 nset 15 nxfemman 0\n";
 
     // Write vertices
 
-    for ( size_t i = 0; i < this->Vertices->size(); i++ ) {
-        OOFEMFile << "node " << i + 1 << "\tcoords 3 " << UsedVertices.at(i)->get_c(0) << "\t" \
-                  << UsedVertices.at(i)->get_c(1) << "\t" << UsedVertices.at(i)->get_c(2) << "\n";
+    for ( size_t i = 0; i < UsedVertices.size(); i++ ) {
+        OOFEMFile << "node " << i + 1 << "\tcoords 3 " << Snapshot->GiveCoordinate(UsedVertices [ i ], 0) << "\t" \
+                  << Snapshot->GiveCoordinate(UsedVertices [ i ], 1) << "\t" << Snapshot->GiveCoordinate(UsedVertices [ i ], 2) << "\n";
     }
 
     // Write elements
 
-    for ( size_t i = 0; i < this->Tets->size(); i++ ) {
-        TetType *t = this->Tets->at(i);
-        OOFEMFile << "ltrspace " << i + 1 << "\tnodes 4\t" << t->Vertices [ 0 ]->tag + 1 \
-                  << "\t" << t->Vertices [ 1 ]->tag + 1 << "\t" << t->Vertices [ 2 ]->tag + 1 << "\t" << t->Vertices [ 3 ]->tag + 1 \
-                  << "\tcrosssect 1 \tmat " << Self2OofemMaterials [ t->MaterialID ] << "\n";
+    for ( size_t i = 0; i < Snapshot->GiveNumberOfTets(); i++ ) {
+        const int *tv = & Snapshot->TetVertices [ 4 * i ];
+        OOFEMFile << "ltrspace " << i + 1 << "\tnodes 4\t" << Snapshot->VolumeVertexIndex [ tv [ 0 ] ] + 1 \
+                  << "\t" << Snapshot->VolumeVertexIndex [ tv [ 1 ] ] + 1 << "\t" << Snapshot->VolumeVertexIndex [ tv [ 2 ] ] + 1 \
+                  << "\t" << Snapshot->VolumeVertexIndex [ tv [ 3 ] ] + 1 \
+                  << "\tcrosssect 1 \tmat " << Self2OofemMaterials [ Snapshot->TetMaterialIDs [ i ] ] << "\n";
     }
 
     // Write cross-section
@@ -94,8 +95,8 @@ void OOFEMExporter :: WriteVolumeData(std :: string Filename)
 
     // Volume set
     OOFEMFile << "# Volume set\n";
-    OOFEMFile << "set " << setid++ << " elements " << this->Tets->size();
-    for ( size_t i = 0; i < this->Tets->size(); i++ ) {
+    OOFEMFile << "set " << setid++ << " elements " << Snapshot->GiveNumberOfTets();
+    for ( size_t i = 0; i < Snapshot->GiveNumberOfTets(); i++ ) {
         OOFEMFile << " " << i + 1;
     }
     OOFEMFile << "\n";
@@ -106,11 +107,11 @@ void OOFEMExporter :: WriteVolumeData(std :: string Filename)
     for ( int i = 0; i < 3; i++ ) {
         // Write max nodes
         for ( size_t j = 0; j < MaxNodes [ i ].size(); j++ ) {
-            OOFEMFile << " " << MaxNodes [ i ].at(j)->tag + 1;
+            OOFEMFile << " " << MaxNodes [ i ].at(j) + 1;
         }
         // Write min nodes
         for ( size_t j = 0; j < MinNodes [ i ].size(); j++ ) {
-            OOFEMFile << " " << MinNodes [ i ].at(j)->tag + 1;
+            OOFEMFile << " " << MinNodes [ i ].at(j) + 1;
         }
     }
     OOFEMFile << "\n";
@@ -123,7 +124,7 @@ void OOFEMExporter :: WriteVolumeData(std :: string Filename)
         OOFEMFile << MaxComments [ i ] << " nodes\n";
         OOFEMFile << "set " << setid++ << " nodes " << MaxNodes [ i ].size();
         for ( size_t j = 0; j < MaxNodes [ i ].size(); j++ ) {
-            OOFEMFile << " " << MaxNodes [ i ].at(j)->tag + 1;
+            OOFEMFile << " " << MaxNodes [ i ].at(j) + 1;
         }
         OOFEMFile << "\n";
 
@@ -131,7 +132,7 @@ void OOFEMExporter :: WriteVolumeData(std :: string Filename)
         OOFEMFile << MinComments [ i ] << " nodes\n";
         OOFEMFile << "set " << setid++ << " nodes " << MinNodes [ i ].size();
         for ( size_t j = 0; j < MinNodes [ i ].size(); j++ ) {
-            OOFEMFile << " " << MinNodes [ i ].at(j)->tag + 1;
+            OOFEMFile << " " << MinNodes [ i ].at(j) + 1;
         }
         OOFEMFile << "\n";
     }
@@ -150,11 +151,11 @@ void OOFEMExporter :: WriteVolumeData(std :: string Filename)
     OOFEMFile << "# Complete boundary by element sides\n";
     OOFEMFile << "set " << setid++ << " elementboundaries " << ecount * 2;
     for ( int k = 0; k < 2; k++ ) {
-        std :: array< std :: vector< TetType * >, 3 > *Elements = ( k == 0 ) ? & MaxElements : & MinElements;
+        std :: array< std :: vector< int >, 3 > *Elements = ( k == 0 ) ? & MaxElements : & MinElements;
         std :: array< std :: vector< int >, 3 > *Sides = ( k == 0 ) ? & MaxSide : & MinSide;
         for ( int i = 0; i < 3; i++ ) {
             for ( size_t j = 0; j < Elements->at(i).size(); j++ ) {
-                OOFEMFile << " " << Elements->at(i).at(j)->ID + 1 << " " << Sides->at(i).at(j);
+                OOFEMFile << " " << Snapshot->TetIDs [ Elements->at(i).at(j) ] + 1 << " " << Sides->at(i).at(j);
             }
         }
     }
@@ -163,14 +164,14 @@ void OOFEMExporter :: WriteVolumeData(std :: string Filename)
     // Boundaries in all directions
     for ( int k = 0; k < 2; k++ ) {
         std :: array< std :: string, 3 > *Comments = ( k == 0 ) ? & MaxComments : & MinComments;
-        std :: array< std :: vector< TetType * >, 3 > *Elements = ( k == 0 ) ? & MaxElements : & MinElements;
+        std :: array< std :: vector< int >, 3 > *Elements = ( k == 0 ) ? & MaxElements : & MinElements;
         std :: array< std :: vector< int >, 3 > *Sides = ( k == 0 ) ? & MaxSide : & MinSide;
 
         for ( int i = 0; i < 3; i++ ) {
             OOFEMFile << Comments->at(i) << " element boundaries\n";
             OOFEMFile << "set " << setid++ << " elementboundaries " << Elements->at(i).size() + Sides->at(i).size();
             for ( size_t j = 0; j < Elements->at(i).size(); j++ ) {
-                OOFEMFile << " " << Elements->at(i).at(j)->ID + 1 << " " << Sides->at(i).at(j);
+                OOFEMFile << " " << Snapshot->TetIDs [ Elements->at(i).at(j) ] + 1 << " " << Sides->at(i).at(j);
             }
             OOFEMFile << "\n";
         }
@@ -23,7 +23,7 @@ public:
     /**
      * @copydoc Exporter::Exporter
      */
-    OOFEMExporter(std :: vector< TriangleType * > *Triangles, std :: vector< VertexType * > *Vertices, std :: vector< EdgeType * > *Edges, std :: vector< TetType * > *Tets);
+    OOFEMExporter(MeshSnapshot *Snapshot);
     virtual void WriteSurfaceData(std :: string Filename) {}
     virtual void WriteVolumeData(std :: string Filename);
 };
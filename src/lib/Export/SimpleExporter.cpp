@@ -7,8 +7,8 @@
 namespace voxel2tet
 {
 
-SimpleExporter :: SimpleExporter(std :: vector< TriangleType * > *Triangles, std :: vector< VertexType * > *Vertices, std :: vector< EdgeType * > *Edges, std :: vector< TetType * > *Tets)
-    : Exporter(Triangles, Vertices, Edges, Tets)
+SimpleExporter :: SimpleExporter(MeshSnapshot *Snapshot)
+    : Exporter(Snapshot)
 {
 
 }
@@ -19,43 +19,29 @@ void  SimpleExporter::WriteSurfaceData(std :: string Filename)
     std :: ofstream SimpleFile;
     SimpleFile.open(Filename);
 
-    // Prepare information
-    std :: vector< VertexType * >UsedVertices;
-    for ( TriangleType *t : *this->Triangles ) {
-        for ( VertexType *v : t->Vertices ) {
-            UsedVertices.push_back(v);
-        }
-    }
-
-    std :: sort( UsedVertices.begin(), UsedVertices.end() );
-    UsedVertices.erase( std :: unique( UsedVertices.begin(), UsedVertices.end() ), UsedVertices.end() );
-
-    int i = 0;
-    for ( VertexType *v : UsedVertices ) {
-        v->tag = i;
-        i++;
-    }
+    const std :: vector< int > &ID = Snapshot->VertexIDs;
 
     // Write header
-    SimpleFile << "# Simple mesh file\n# Vertices\n" << UsedVertices.size() << "\n";
+    SimpleFile << "# Simple mesh file\n# Vertices\n" << Snapshot->SurfaceVertices.size() << "\n";
 
     // Write vertices
-    for ( auto v : UsedVertices ) {
-        SimpleFile << std :: setiosflags(std :: ios :: fixed) << std :: setprecision(15) << v->ID << " " << v->get_c(0) << " " << v->get_c(1) << " " << v->get_c(2) << "\n";
+    for ( int v : Snapshot->SurfaceVertices ) {
+        SimpleFile << std :: setiosflags(std :: ios :: fixed) << std :: setprecision(15) << ID [ v ] << " " << Snapshot->GiveCoordinate(v, 0) << " " << Snapshot->GiveCoordinate(v, 1) << " " << Snapshot->GiveCoordinate(v, 2) << "\n";
     }
 
     // Write edges
-    SimpleFile << "# Edges\n" << this->Edges->size() << "\n";
+    SimpleFile << "# Edges\n" << Snapshot->GiveNumberOfEdges() << "\n";
 
-    for (EdgeType *e: *this->Edges) {
-        SimpleFile << e->ID << "\t" << e->Vertices[0]->ID << "\t" << e->Vertices[1]->ID << "\n";
+    for (size_t i = 0; i < Snapshot->GiveNumberOfEdges(); i++) {
+        SimpleFile << Snapshot->EdgeIDs[i] << "\t" << ID[Snapshot->EdgeVertices[2*i]] << "\t" << ID[Snapshot->EdgeVertices[2*i+1]] << "\n";
     }
 
     // Write triangles
-    SimpleFile << "# Triangles\n" << this->Triangles->size() << "\n";
+    SimpleFile << "# Triangles\n" << Snapshot->GiveNumberOfTriangles() << "\n";
 
-    for (TriangleType *t: *this->Triangles) {
-        SimpleFile << t->ID << "\t" << t->Vertices[0]->ID << "\t" << t->Vertices[1]->ID << "\t"<< t->Vertices[2]->ID << "\n";
+    for (size_t i = 0; i < Snapshot->GiveNumberOfTriangles(); i++) {
+        const int *tv = &Snapshot->TriangleVertices[3*i];
+        SimpleFile << Snapshot->TriangleIDs[i] << "\t" << ID[tv[0]] << "\t" << ID[tv[1]] << "\t"<< ID[tv[2]] << "\n";
     }
 
 }
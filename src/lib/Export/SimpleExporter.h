@@ -20,7 +20,7 @@ public:
     /**
      * @copydoc Exporter::Exporter
      */
-    SimpleExporter(std :: vector< TriangleType * > *Triangles, std :: vector< VertexType * > *Vertices, std :: vector< EdgeType * > *Edges, std :: vector< TetType * > *Tets);
+    SimpleExporter(MeshSnapshot *Snapshot);
     virtual void WriteSurfaceData(std :: string Filename);
     virtual void WriteVolumeData(std :: string Filename) {}
 
@@ -5,8 +5,8 @@
 namespace voxel2tet
 {
 
-TetGenExporter :: TetGenExporter(std :: vector< TriangleType * > *Triangles, std :: vector< VertexType * > *Vertices, std :: vector< EdgeType * > *Edges, std :: vector< TetType * > *Tets) :
-    Exporter(Triangles, Vertices, Edges, Tets)
+TetGenExporter :: TetGenExporter(MeshSnapshot *Snapshot) :
+    Exporter(Snapshot)
 {
     LOG("Create TetGenExporter object\n", 0);
 }
@@ -17,27 +17,24 @@ void TetGenExporter :: WriteSurfaceData(std :: string Filename)
     std :: ofstream TetGenFile;
     TetGenFile.open(Filename);
 
+    const std :: vector< int > &ID = Snapshot->VertexIDs;
+
     TetGenFile << "# Node definitions\n";
-    TetGenFile << this->Vertices->size() << "\t3\t0\t0\n";
+    TetGenFile << Snapshot->GiveNumberOfVertices() << "\t3\t0\t0\n";
 
-    for ( auto v : *this->Vertices ) {
-        TetGenFile << v->ID << "\t" << v->get_c(0) << "\t" << v->get_c(1) << "\t" << v->get_c(2) << "\n";
+    for ( size_t v = 0; v < Snapshot->GiveNumberOfVertices(); v++ ) {
+        TetGenFile << ID [ v ] << "\t" << Snapshot->GiveCoordinate(v, 0) << "\t" << Snapshot->GiveCoordinate(v, 1) << "\t" << Snapshot->GiveCoordinate(v, 2) << "\n";
     }
 
     TetGenFile << "\n # Facet list\n";
-    TetGenFile << this->Triangles->size() << "\t0\n";
-
-    int j = 0;
+    TetGenFile << Snapshot->GiveNumberOfTriangles() << "\t0\n";
 
-    for ( auto t : *this->Triangles ) {
+    for ( size_t j = 0; j < Snapshot->GiveNumberOfTriangles(); j++ ) {
         TetGenFile << 1 << "\n" << 3;
-        std :: array< int, 3 >VertexIDs;
         for ( int i = 0; i < 3; i++ ) {
-            VertexIDs [ i ] = t->Vertices [ i ]->ID;
-            TetGenFile << "\t" << VertexIDs [ i ];
+            TetGenFile << "\t" << ID [ Snapshot->TriangleVertices [ 3 * j + i ] ];
         }
         TetGenFile << "\n";
-        j++;
     }
 }
 }
@@ -20,7 +20,7 @@ public:
     /**
      * @copydoc Exporter::Exporter
      */
-    TetGenExporter(std :: vector< TriangleType * > *Triangles, std :: vector< VertexType * > *Vertices, std :: vector< EdgeType * > *Edges, std :: vector< TetType * > *Tets);
+    TetGenExporter(MeshSnapshot *Snapshot);
     virtual void WriteSurfaceData(std :: string Filename);
     virtual void WriteVolumeData(std :: string Filename) {}
 };
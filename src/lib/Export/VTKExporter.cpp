@@ -3,18 +3,17 @@
 namespace voxel2tet
 {
 
-VTKExporter :: VTKExporter(std :: vector< TriangleType * > *Triangles, std :: vector< VertexType * > *Vertices, std :: vector< EdgeType * > *Edges, std :: vector< TetType * > *Tets) :
-    Exporter(Triangles, Vertices, Edges, Tets)
+VTKExporter :: VTKExporter(MeshSnapshot *Snapshot) :
+    Exporter(Snapshot)
 {}
 
 vtkSmartPointer< vtkPoints >VTKExporter :: SetupVertices()
 {
     vtkSmartPointer< vtkPoints >Points = vtkPoints :: New();
 
-    for ( unsigned int i = 0; i < this->Vertices->size(); i++ ) {
-        VertexType *v = this->Vertices->at(i);
-        this->VertexMap [ v ] = i;
-        Points->InsertNextPoint( v->get_c(0), v->get_c(1), v->get_c(2) );
+    Points->SetNumberOfPoints( Snapshot->GiveNumberOfVertices() );
+    for ( unsigned int i = 0; i < Snapshot->GiveNumberOfVertices(); i++ ) {
+        Points->SetPoint( i, Snapshot->GiveCoordinate(i, 0), Snapshot->GiveCoordinate(i, 1), Snapshot->GiveCoordinate(i, 2) );
     }
     return Points;
 }
@@ -22,15 +21,11 @@ vtkSmartPointer< vtkPoints >VTKExporter :: SetupVertices()
 vtkSmartPointer< vtkCellArray >VTKExporter :: SetupTriangles()
 {
     vtkSmartPointer< vtkCellArray >Cells = vtkCellArray :: New();
-    for ( unsigned int i = 0; i < this->Triangles->size(); i++ ) {
-        TriangleType *t = this->Triangles->at(i);
-        vtkSmartPointer< vtkTriangle >triangle = vtkSmartPointer< vtkTriangle > :: New();
+    for ( unsigned int i = 0; i < Snapshot->GiveNumberOfTriangles(); i++ ) {
+        Cells->InsertNextCell(3);
         for ( int j = 0; j < 3; j++ ) {
-            VertexType *v = t->Vertices [ j ];
-            int VertexId = this->VertexMap [ v ];
-            triangle->GetPointIds()->SetId(j, VertexId);
+            Cells->InsertCellPoint(Snapshot->TriangleVertices [ 3 * i + j ]);
         }
-        Cells->InsertNextCell(triangle);
     }
     return Cells;
 }
@@ -38,67 +33,37 @@ vtkSmartPointer< vtkCellArray >VTKExporter :: SetupTriangles()
 vtkSmartPointer< vtkCellArray >VTKExporter :: SetupTetrahedrons()
 {
     vtkSmartPointer< vtkCellArray >Cells = vtkCellArray :: New();
-    for ( unsigned int i = 0; i < this->Tets->size(); i++ ) {
-        TetType *t = this->Tets->at(i);
-        vtkSmartPointer< vtkTetra >tet = vtkSmartPointer< vtkTetra > :: New();
+    for ( unsigned int i = 0; i < Snapshot->GiveNumberOfTets(); i++ ) {
+        Cells->InsertNextCell(4);
         for ( int j = 0; j < 4; j++ ) {
-            VertexType *v = t->Vertices [ j ];
-            tet->GetPointIds()->SetId(j,  this->VertexMap [ v ]);
+            Cells->InsertCellPoint(Snapshot->TetVertices [ 4 * i + j ]);
         }
-        Cells->InsertNextCell(tet);
     }
     return Cells;
 }
 
-vtkSmartPointer< vtkIntArray >VTKExporter :: SetupTriangleField(std :: string Name, int TriangleType :: *FieldPtr)
+vtkSmartPointer< vtkIntArray >VTKExporter :: SetupField(std :: string Name, const std :: vector< int > &Values)
 {
-    vtkSmartPointer< vtkIntArray >Triangles = vtkIntArray :: New();
-    Triangles->SetNumberOfComponents(1);
-    Triangles->SetName( Name.c_str() );
-    for ( unsigned int i = 0; i < this->Triangles->size(); i++ ) {
-        TriangleType *v = this->Triangles->at(i);
-        int ThisValue = v->*FieldPtr;
-        Triangles->InsertNextValue(ThisValue);
+    vtkSmartPointer< vtkIntArray >Field = vtkIntArray :: New();
+    Field->SetNumberOfComponents(1);
+    Field->SetName( Name.c_str() );
+    Field->SetNumberOfTuples( Values.size() );
+    for ( unsigned int i = 0; i < Values.size(); i++ ) {
+        Field->SetValue(i, Values [ i ]);
     }
-    return Triangles;
+    return Field;
 }
 
-vtkSmartPointer< vtkIntArray >VTKExporter :: SetupTetField(std :: string Name, int TetType :: *FieldPtr)
+vtkSmartPointer< vtkFloatArray >VTKExporter :: SetupField(std :: string Name, const std :: vector< double > &Values)
 {
-    vtkSmartPointer< vtkIntArray >Triangles = vtkIntArray :: New();
-    Triangles->SetNumberOfComponents(1);
-    Triangles->SetName( Name.c_str() );
-    for ( unsigned int i = 0; i < this->Tets->size(); i++ ) {
-        TetType *t = this->Tets->at(i);
-        int ThisValue = t->*FieldPtr;
-        Triangles->InsertNextValue(ThisValue);
+    vtkSmartPointer< vtkFloatArray >Field = vtkFloatArray :: New();
+    Field->SetNumberOfComponents(1);
+    Field->SetName( Name.c_str() );
+    Field->SetNumberOfTuples( Values.size() );
+    for ( unsigned int i = 0; i < Values.size(); i++ ) {
+        Field->SetValue(i, Values [ i ]);
     }
-    return Triangles;
-}
-
-vtkSmartPointer< vtkIntArray >VTKExporter :: SetupVertexField(std :: string Name, int VertexType :: *FieldPtr)
-{
-    vtkSmartPointer< vtkIntArray >VertexIDs = vtkIntArray :: New();
-    VertexIDs->SetNumberOfComponents(1);
-    VertexIDs->SetName( Name.c_str() );
-    for ( unsigned int i = 0; i < this->Vertices->size(); i++ ) {
-        VertexType *v = this->Vertices->at(i);
-        int ThisID = v->*FieldPtr;
-        VertexIDs->InsertNextValue(ThisID);
-    }
-    return VertexIDs;
-}
-
-vtkSmartPointer< vtkFloatArray >VTKExporter :: SetupVertexField( std :: string Name, double ( VertexType :: *FieldPtr ) )
-{
-    vtkSmartPointer< vtkFloatArray >VertexIDs = vtkFloatArray :: New();
-    VertexIDs->SetNumberOfComponents(1);
-    VertexIDs->SetName( Name.c_str() );
-    for ( unsigned int i = 0; i < this->Vertices->size(); i++ ) {
-        VertexType *v = this->Vertices->at(i);
-        VertexIDs->InsertNextValue(v->*FieldPtr);
-    }
-    return VertexIDs;
+    return Field;
 }
 
 void VTKExporter :: WriteSurfaceData(std :: string Filename)
@@ -110,34 +75,34 @@ void VTKExporter :: WriteSurfaceData(std :: string Filename)
     PolyData->SetPoints(Points);
 
     // ID
-    vtkSmartPointer< vtkIntArray >VertexID = SetupVertexField("Vertex ID", & VertexType :: ID);
+    vtkSmartPointer< vtkIntArray >VertexID = SetupField("Vertex ID", Snapshot->VertexIDs);
     PolyData->GetPointData()->AddArray(VertexID);
 
     // tag
-    vtkSmartPointer< vtkIntArray >VertexTag = SetupVertexField("Vertex tag", & VertexType :: tag);
+    vtkSmartPointer< vtkIntArray >VertexTag = SetupField("Vertex tag", Snapshot->VertexTags);
     PolyData->GetPointData()->AddArray(VertexTag);
 
     // Error
-    vtkSmartPointer< vtkFloatArray >VertexError = SetupVertexField("Coarsen error", & VertexType :: error);
+    vtkSmartPointer< vtkFloatArray >VertexError = SetupField("Coarsen error", Snapshot->VertexErrors);
     PolyData->GetPointData()->AddArray(VertexError);
 
     // Triangles
     PolyData->SetPolys(TriangleArrays);
 
     // Interface ID
-    vtkSmartPointer< vtkIntArray >InterfaceID = SetupTriangleField("Interface ID", & TriangleType :: InterfaceID);
+    vtkSmartPointer< vtkIntArray >InterfaceID = SetupField("Interface ID", Snapshot->InterfaceIDs);
     PolyData->GetCellData()->AddArray(InterfaceID);
 
     // Triangle ID
-    vtkSmartPointer< vtkIntArray >TriangleID = SetupTriangleField("Triangle ID", & TriangleType :: ID);
+    vtkSmartPointer< vtkIntArray >TriangleID = SetupField("Triangle ID", Snapshot->TriangleIDs);
     PolyData->GetCellData()->AddArray(TriangleID);
 
     // Positive normal phase
-    vtkSmartPointer< vtkIntArray >TrianglePosNormalPhase = SetupTriangleField("PosNormalMatID", & TriangleType :: PosNormalMatID);
+    vtkSmartPointer< vtkIntArray >TrianglePosNormalPhase = SetupField("PosNormalMatID", Snapshot->PosNormalMatIDs);
     PolyData->GetCellData()->AddArray(TrianglePosNormalPhase);
 
     // Negative normal phase
-    vtkSmartPointer< vtkIntArray >TriangleNegNormalPhase = SetupTriangleField("NegNormalMatID", & TriangleType :: NegNormalMatID);
+    vtkSmartPointer< vtkIntArray >TriangleNegNormalPhase = SetupField("NegNormalMatID", Snapshot->NegNormalMatIDs);
     PolyData->GetCellData()->AddArray(TriangleNegNormalPhase);
 
     vtkSmartPointer< vtkXMLPolyDataWriter >XMLWriter = vtkSmartPointer< vtkXMLPolyDataWriter > :: New();
@@ -160,10 +125,10 @@ void VTKExporter :: WriteVolumeData(std :: string Filename)
 
     UnstructuredGrid->SetCells(VTK_TETRA, TetArrays);
 
-    vtkSmartPointer< vtkIntArray >TetID = SetupTetField("Tet ID", & TetType :: ID);
+    vtkSmartPointer< vtkIntArray >TetID = SetupField("Tet ID", Snapshot->TetIDs);
     UnstructuredGrid->GetCellData()->AddArray(TetID);
 
-    vtkSmartPointer< vtkIntArray >MatID = SetupTetField("Mat ID", & TetType :: MaterialID);
+    vtkSmartPointer< vtkIntArray >MatID = SetupField("Mat ID", Snapshot->TetMaterialIDs);
     UnstructuredGrid->GetCellData()->AddArray(MatID);
 
     vtkSmartPointer< vtkXMLUnstructuredGridWriter >XMLWriter = vtkSmartPointer< vtkXMLUnstructuredGridWriter > :: New();
@@ -2,7 +2,7 @@
 #define VTKEXPORTER_H
 
 #include <string>
-#include <map>
+#include <vector>
 
 #include "Exporter.h"
 #include "MeshComponents.h"
@@ -30,22 +30,18 @@ namespace voxel2tet
 class VTKExporter : public Exporter
 {
 private:
-    std :: map< VertexType *, int >VertexMap;
-
     vtkSmartPointer< vtkPoints >SetupVertices();
     vtkSmartPointer< vtkCellArray >SetupTriangles();
     vtkSmartPointer< vtkCellArray >SetupTetrahedrons();
 
-    vtkSmartPointer< vtkIntArray >SetupVertexField( std :: string Name, int ( VertexType :: *FieldPtr ) );
-    vtkSmartPointer< vtkFloatArray >SetupVertexField( std :: string Name, double ( VertexType :: *FieldPtr ) );
-    vtkSmartPointer< vtkIntArray >SetupTriangleField(std :: string Name, int TriangleType :: *FieldPtr);
-    vtkSmartPointer< vtkIntArray >SetupTetField(std :: string Name, int TetType :: *FieldPtr);
+    vtkSmartPointer< vtkIntArray >SetupField(std :: string Name, const std :: vector< int > &Values);
+    vtkSmartPointer< vtkFloatArray >SetupField(std :: string Name, const std :: vector< double > &Values);
 
 public:
     /**
      * @copydoc Exporter::Exporter
      */
-    VTKExporter(std :: vector< TriangleType * > *Triangles, std :: vector< VertexType * > *Vertices, std :: vector< EdgeType * > *Edges, std :: vector< TetType * > *Tets);
+    VTKExporter(MeshSnapshot *Snapshot);
     void WriteSurfaceData(std :: string Filename);
     void WriteVolumeData(std :: string Filename);
 };
@@ -47,6 +47,44 @@ std :: string strfmt(const std :: string &format, Args ... args)
     return std :: string(buf.get(), buf.get() + size - 1); // We don't want the '\0' inside
 }
 
+/**
+ * @brief Calls Function(i) for i = Start...End-1 in parallel. Exceptions cannot leave a parallel region, thus an exception
+ * thrown by Function is caught and reported by the return value once all calls are done.
+ * @param Start First index
+ * @param End One past the last index
+ * @param Balance If true, the indices are distributed one by one to the threads, which suits few calls of varying cost.
+ * Otherwise, each thread is given a fixed range of indices.
+ * @param Function Function taking the index
+ * @return True if no call threw an exception
+ */
+template< typename FunctionType >
+bool ParallelFor(int Start, int End, bool Balance, FunctionType Function)
+{
+    int failed = 0;
+    auto Call = [ & ](int i) {
+                    try {
+                        Function(i);
+                    } catch ( ... ) {
+#pragma omp atomic write
+                        failed = 1;
+                    }
+                };
+
+    if ( Balance ) {
+#pragma omp parallel for schedule(dynamic, 1)
+        for ( int i = Start; i < End; i++ ) {
+            Call(i);
+        }
+    } else {
+#pragma omp parallel for schedule(static)
+        for ( int i = Start; i < End; i++ ) {
+            Call(i);
+        }
+    }
+
+    return !failed;
+}
+
 std :: array< double, 3 >ComputeNormalizedVector(VertexType *v1, VertexType *v2);
 
 double ComputeAngleBetweenVectors(std :: array< double, 3 >v1, std :: array< double, 3 >v2);
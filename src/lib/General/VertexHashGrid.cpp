@@ -0,0 +1,313 @@
+#include <stdio.h>
+#include <cmath>
+#include <stdexcept>
+
+#include "VertexHashGrid.h"
+
+namespace voxel2tet
+{
+const uint64_t VertexHashGrid :: NoCell;
+
+VertexHashGrid :: VertexHashGrid(BoundingBoxType BoundingBox, std :: vector< VertexType * > *Vertices)
+{
+    this->BoundingBox = BoundingBox;
+    this->Vertices = Vertices;
+    this->eps = EPS;
+
+    std :: array< double, 3 >DefaultCellSize;
+    for ( int i = 0; i < 3; i++ ) {
+        DefaultCellSize [ i ] = ( BoundingBox.maxvalues [ i ] - BoundingBox.minvalues [ i ] ) / 128.0;
+        if ( DefaultCellSize [ i ] <= 0.0 ) {
+            DefaultCellSize [ i ] = 1.0;
+        }
+    }
+    this->SetCellSize(DefaultCellSize);
+}
+
+void VertexHashGrid :: SetCellSize(std :: array< double, 3 >CellSize)
+{
+    this->CellSize = CellSize;
+    for ( int i = 0; i < 3; i++ ) {
+        this->Origin [ i ] = this->BoundingBox.minvalues [ i ] - CellSize [ i ] / 2.0;
+    }
+
+    // Rehash all vertices already added
+    this->Rebuild();
+}
+
+void VertexHashGrid :: Rebuild()
+{
+    this->Cells.clear();
+    this->Cells.reserve( this->VertexKeys.size() );
+    for ( size_t VertexID = 0; VertexID < this->VertexKeys.size(); VertexID++ ) {
+        if ( this->VertexKeys [ VertexID ] == NoCell ) {
+            continue;
+        }
+        VertexType *v = this->Vertices->at(VertexID);
+        this->VertexKeys [ VertexID ] = this->GiveKey( this->GiveCellIndex( v->get_c(0), v->get_c(1), v->get_c(2) ) );
+        this->Cells [ this->VertexKeys [ VertexID ] ].push_back(VertexID);
+    }
+}
+
+void VertexHashGrid :: InsertInCell(int VertexID, uint64_t Key)
+{
+    this->Cells [ Key ].push_back(VertexID);
+    this->VertexKeys [ VertexID ] = Key;
+}
+
+void VertexHashGrid :: RemoveFromCell(int VertexID, uint64_t Key)
+{
+    auto Cell = this->Cells.find(Key);
+    if ( Cell == this->Cells.end() ) {
+        return;
+    }
+
+    std :: vector< int > &VertexIDs = Cell->second;
+    for ( size_t i = 0; i < VertexIDs.size(); i++ ) {
+        if ( VertexIDs [ i ] == VertexID ) {
+            VertexIDs [ i ] = VertexIDs.back();
+            VertexIDs.pop_back();
+            break;
+        }
+    }
+
+    if ( VertexIDs.empty() ) {
+        this->Cells.erase(Cell);
+    }
+    this->VertexKeys [ VertexID ] = NoCell;
+}
+
+void VertexHashGrid :: RemoveVertex(int VertexID)
+{
+    if ( this->VertexKeys.at(VertexID) == NoCell ) {
+        return;
+    }
+    this->RemoveFromCell(VertexID, this->VertexKeys [ VertexID ]);
+}
+
+void VertexHashGrid :: MoveVertex(int VertexID)
+{
+    uint64_t OldKey = this->VertexKeys.at(VertexID);
+    if ( OldKey == NoCell ) {
+        return;
+    }
+
+    VertexType *v = this->Vertices->at(VertexID);
+    uint64_t NewKey = this->GiveKey( this->GiveCellIndex( v->get_c(0), v->get_c(1), v->get_c(2) ) );
+    if ( NewKey != OldKey ) {
+        this->RemoveFromCell(VertexID, OldKey);
+        this->InsertInCell(VertexID, NewKey);
+    }
+}
+
+std :: array< int, 3 >VertexHashGrid :: GiveCellIndex(double x, double y, double z) const
+{
+    return { {
+                 int( std :: floor( ( x - this->Origin [ 0 ] ) / this->CellSize [ 0 ] ) ),
+                 int( std :: floor( ( y - this->Origin [ 1 ] ) / this->CellSize [ 1 ] ) ),
+                 int( std :: floor( ( z - this->Origin [ 2 ] ) / this->CellSize [ 2 ] ) )
+             } };
+}
+
+uint64_t VertexHashGrid :: GiveKey(std :: array< int, 3 >CellIndex) const
+{
+    // 21 bits for each direction. The offset allows for cells slightly outside the bounding box.
+    uint64_t Key = 0;
+    for ( int i = 0; i < 3; i++ ) {
+        Key = ( Key << 21 ) | ( uint64_t( CellIndex [ i ] + ( 1 << 20 ) ) & 0x1FFFFF );
+    }
+    return Key;
+}
+
+int VertexHashGrid :: FindVertexIndex(double x, double y, double z) const
+{
+    // Compare using the precision used for storing the coordinates
+    double c [ 3 ] = {
+        CoordinateType(x), CoordinateType(y), CoordinateType(z)
+    };
+
+    // Probe the cell of the coordinate and neighbouring cells closer than eps
+    std :: array< int, 3 >MinIndex = this->GiveCellIndex(c [ 0 ] - this->eps, c [ 1 ] - this->eps, c [ 2 ] - this->eps);
+    std :: array< int, 3 >MaxIndex = this->GiveCellIndex(c [ 0 ] + this->eps, c [ 1 ] + this->eps, c [ 2 ] + this->eps);
+
+    for ( int i = MinIndex [ 0 ]; i <= MaxIndex [ 0 ]; i++ ) {
+        for ( int j = MinIndex [ 1 ]; j <= MaxIndex [ 1 ]; j++ ) {
+            for ( int k = MinIndex [ 2 ]; k <= MaxIndex [ 2 ]; k++ ) {
+                auto Cell = this->Cells.find( this->GiveKey({ { i, j, k } }) );
+                if ( Cell == this->Cells.end() ) {
+                    continue;
+                }
+                for ( int VertexID : Cell->second ) {
+                    VertexType *v = this->Vertices->at(VertexID);
+                    double d2 = 0.0;
+                    for ( int m = 0; m < 3; m++ ) {
+                        d2 = d2 + ( v->get_c(m) - c [ m ] ) * ( v->get_c(m) - c [ m ] );
+                    }
+                    if ( d2 < this->eps * this->eps ) {
+                        return VertexID;
+                    }
+                }
+            }
+        }
+    }
+
+    return -1;
+}
+
+VertexType *VertexHashGrid :: FindVertexByCoords(double x, double y, double z) const
+{
+    int VertexID = this->FindVertexIndex(x, y, z);
+    if ( VertexID == -1 ) {
+        return NULL;
+    }
+    return this->Vertices->at(VertexID);
+}
+
+int VertexHashGrid :: AddVertex(double x, double y, double z)
+{
+    int VertexID = this->FindVertexIndex(x, y, z);
+    if ( VertexID != -1 ) {
+        return VertexID;
+    }
+
+    if ( this->IsInBoundingBox(x, y, z) == false ) {
+        throw std :: out_of_range("Vertex is located outside the bounding box");
+    }
+
+    this->Vertices->push_back( new VertexType(x, y, z) );
+    VertexID = this->Vertices->size() - 1;
+    this->Vertices->at(VertexID)->ID = VertexID;
+
+    VertexType *v = this->Vertices->at(VertexID);
+    this->VertexKeys.resize(this->Vertices->size(), NoCell);
+    this->InsertInCell( VertexID, this->GiveKey( this->GiveCellIndex( v->get_c(0), v->get_c(1), v->get_c(2) ) ) );
+
+    return VertexID;
+}
+
+int VertexHashGrid :: AddVertices(const double *Coordinates, size_t NumberOfVertices, bool Unique)
+{
+    int FirstID = this->Vertices->size();
+
+    if ( !Unique ) {
+        for ( size_t i = 0; i < NumberOfVertices; i++ ) {
+            this->AddVertex(Coordinates [ 3 * i ], Coordinates [ 3 * i + 1 ], Coordinates [ 3 * i + 2 ]);
+        }
+        return FirstID;
+    }
+
+    // Create vertices and compute the key of the cell of each vertex
+    std :: vector< std :: pair< uint64_t, int > >Keys;
+    Keys.reserve(NumberOfVertices);
+    this->Vertices->reserve(FirstID + NumberOfVertices);
+    for ( size_t i = 0; i < NumberOfVertices; i++ ) {
+        const double *c = & Coordinates [ 3 * i ];
+        if ( this->IsInBoundingBox(c [ 0 ], c [ 1 ], c [ 2 ]) == false ) {
+            throw std :: out_of_range("Vertex is located outside the bounding box");
+        }
+
+        VertexType *v = new VertexType(c [ 0 ], c [ 1 ], c [ 2 ]);
+        v->ID = FirstID + i;
+        this->Vertices->push_back(v);
+        Keys.push_back({ this->GiveKey( this->GiveCellIndex( v->get_c(0), v->get_c(1), v->get_c(2) ) ), v->ID });
+    }
+
+    this->VertexKeys.resize(this->Vertices->size(), NoCell);
+    this->Cells.reserve(this->Cells.size() + NumberOfVertices);
+    for ( auto &Key : Keys ) {
+        this->InsertInCell(Key.second, Key.first);
+    }
+
+    return FirstID;
+}
+
+bool VertexHashGrid :: IsInBoundingBox(double x, double y, double z) const
+{
+    if ( ( x >= this->BoundingBox.minvalues [ 0 ] ) & ( y >= this->BoundingBox.minvalues [ 1 ] ) & ( z >= this->BoundingBox.minvalues [ 2 ] ) &
+         ( x < this->BoundingBox.maxvalues [ 0 ] ) & ( y < this->BoundingBox.maxvalues [ 1 ] ) & ( z < this->BoundingBox.maxvalues [ 2 ] ) ) {
+        return true;
+    }
+    return false;
+}
+
+std :: vector< VertexType * >VertexHashGrid :: GiveVerticesWithinSphere(double x, double y, double z, double r) const
+{
+    std :: vector< VertexType * >ResultList;
+    this->GiveVerticesWithinSphere(x, y, z, r, ResultList);
+    return ResultList;
+}
+
+void VertexHashGrid :: GiveVerticesWithinSphere(double x, double y, double z, double r, std :: vector< VertexType * > &ResultList) const
+{
+    ResultList.clear();
+    double P [ 3 ] = {
+        x, y, z
+    };
+
+    auto TestCell = [ & ](const std :: vector< int > &VertexIDs) {
+                        for ( int VertexID : VertexIDs ) {
+                            VertexType *v = this->Vertices->at(VertexID);
+                            double d2 = 0.0;
+                            for ( int m = 0; m < 3; m++ ) {
+                                d2 = d2 + ( v->get_c(m) - P [ m ] ) * ( v->get_c(m) - P [ m ] );
+                            }
+                            if ( d2 < r * r ) {
+                                ResultList.push_back(v);
+                            }
+                        }
+                    };
+
+    std :: array< int, 3 >MinIndex = this->GiveCellIndex(x - r, y - r, z - r);
+    std :: array< int, 3 >MaxIndex = this->GiveCellIndex(x + r, y + r, z + r);
+
+    double NumberOfCells = 1.0;
+    for ( int i = 0; i < 3; i++ ) {
+        NumberOfCells = NumberOfCells * ( MaxIndex [ i ] - MinIndex [ i ] + 1 );
+    }
+
+    if ( NumberOfCells > this->Cells.size() ) {
+        // The sphere covers more cells than are occupied. Test all occupied cells instead.
+        for ( auto &Cell : this->Cells ) {
+            TestCell(Cell.second);
+        }
+        return;
+    }
+
+    for ( int i = MinIndex [ 0 ]; i <= MaxIndex [ 0 ]; i++ ) {
+        for ( int j = MinIndex [ 1 ]; j <= MaxIndex [ 1 ]; j++ ) {
+            for ( int k = MinIndex [ 2 ]; k <= MaxIndex [ 2 ]; k++ ) {
+                auto Cell = this->Cells.find( this->GiveKey({ { i, j, k } }) );
+                if ( Cell != this->Cells.end() ) {
+                    TestCell(Cell->second);
+                }
+            }
+        }
+    }
+}
+
+void VertexHashGrid :: RenumberVertices(std :: vector< int > &NewIndices)
+{
+    for ( auto &Cell : this->Cells ) {
+        for ( auto &VertexID : Cell.second ) {
+            VertexID = NewIndices.at(VertexID);
+        }
+    }
+
+    std :: vector< uint64_t >NewVertexKeys(this->VertexKeys.size(), NoCell);
+    for ( size_t i = 0; i < this->VertexKeys.size(); i++ ) {
+        NewVertexKeys [ NewIndices.at(i) ] = this->VertexKeys [ i ];
+    }
+    this->VertexKeys.swap(NewVertexKeys);
+}
+
+void VertexHashGrid :: printself()
+{
+    printf( "Cell size (%f, %f, %f), %u occupied cells\n", this->CellSize [ 0 ], this->CellSize [ 1 ], this->CellSize [ 2 ], ( unsigned int ) this->Cells.size() );
+    for ( auto &Cell : this->Cells ) {
+        printf("Cell %lu\n", ( unsigned long ) Cell.first);
+        for ( auto VertexID : Cell.second ) {
+            printf( "\t#%u: (%f, %f, %f)\n", VertexID, this->Vertices->at(VertexID)->get_c(0), this->Vertices->at(VertexID)->get_c(1), this->Vertices->at(VertexID)->get_c(2) );
+        }
+    }
+}
+}
@@ -0,0 +1,187 @@
+#ifndef VERTEXHASHGRID_H
+#define VERTEXHASHGRID_H
+
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+
+#include <Importer.h>
+#include "MeshComponents.h"
+#include "MiscFunctions.h"
+
+namespace voxel2tet
+{
+
+/**
+ * @brief Provides a spatial hash for storing and accessing vertices by coordinate.
+ *
+ * Space is divided into a uniform grid of cells. Each coordinate is quantized to the cell containing it and the cells
+ * that hold vertices are stored in a hash map. Adding or finding a vertex thus only requires looking in the cell of the
+ * coordinate and, when the coordinate is closer than the tolerance to a cell boundary, in the neighbouring cells. The
+ * expected cost is O(1) given that the cell size is in the order of the distance between vertices, e.g. the voxel spacing.
+ *
+ * Two coordinates are considered equal if their distance is less than eps. The same tolerance is used both when adding
+ * and when finding vertices.
+ *
+ * The cell of each vertex is determined by its position when it is added. Vertices moved afterwards, e.g. by smoothing,
+ * must be rehashed using MoveVertex or Rebuild, and vertices no longer part of the mesh are removed using RemoveVertex.
+ * Otherwise, queries will miss moved vertices and report removed ones.
+ *
+ * Concurrency: All const member functions only read the structure and may be called from several threads at the same
+ * time, given that no thread modifies the structure or moves any vertex in the meanwhile. Use the overloads taking a
+ * result list to reuse the same buffer between queries. All non-const member functions require exclusive access.
+ */
+class VertexHashGrid
+{
+private:
+    BoundingBoxType BoundingBox;
+    double eps;
+
+    // Size of cells in each direction
+    std :: array< double, 3 >CellSize;
+
+    // Origin of the grid. This is offset half a cell from the bounding box such that vertices on a regular grid with the
+    // same spacing are located at the centers of the cells.
+    std :: array< double, 3 >Origin;
+
+    // Indices pointing to this->Vertices for each occupied cell
+    std :: unordered_map< uint64_t, std :: vector< int > >Cells;
+
+    // Key of the cell each vertex is stored in, indexed as this->Vertices. Removed vertices are marked with NoCell.
+    std :: vector< uint64_t >VertexKeys;
+    static const uint64_t NoCell = UINT64_MAX;
+
+    // Stores a vertex index in the cell with the given key
+    void InsertInCell(int VertexID, uint64_t Key);
+
+    // Removes a vertex index from the cell with the given key. The cell is removed when empty.
+    void RemoveFromCell(int VertexID, uint64_t Key);
+
+    // Index of cell in each direction containing the coordinate
+    std :: array< int, 3 >GiveCellIndex(double x, double y, double z) const;
+
+    // Hash key of cell
+    uint64_t GiveKey(std :: array< int, 3 >CellIndex) const;
+
+    // Returns the index of a vertex within eps from the coordinate or -1 if not found
+    int FindVertexIndex(double x, double y, double z) const;
+
+    // Determines wether a coordinate is located within the bounding box
+    bool IsInBoundingBox(double x, double y, double z) const;
+public:
+
+    /**
+     * @brief Constructor.
+     * @param BoundingBox Bounding box for the complete structure
+     * @param Vertices Pointer to a list for vertices. This is the list of vertices used henceforth.
+     */
+    VertexHashGrid(BoundingBoxType BoundingBox, std :: vector< VertexType * > *Vertices);
+
+    /**
+     * @brief List of vertices.
+     */
+    std :: vector< VertexType * > *Vertices;
+
+    /**
+     * @brief Set size of cells and rehash all vertices. For best performance, this should be close to the smallest
+     * distance between vertices, e.g. the voxel spacing. The default is 1/128 of the size of the bounding box.
+     * @param CellSize Size of cells in each direction
+     */
+    void SetCellSize(std :: array< double, 3 >CellSize);
+
+    /**
+     * @brief Give size of cells
+     * @return Size of cells in each direction
+     */
+    std :: array< double, 3 >GiveCellSize() const { return this->CellSize; }
+
+    /**
+     * @brief Adds a vertex at a specified coordinate to the structure.
+     *
+     * If a vertex at the spcified coordinate already exists, the index of that vertex is returned, otherwise, the index of the new vertex is returned.
+     *
+     * @param x X coordinate
+     * @param y Y coordinate
+     * @param z Z coordinate
+     * @return Index of vertex
+     */
+    int AddVertex(double x, double y, double z);
+
+    /**
+     * @brief Adds a list of vertices to the structure at once.
+     *
+     * If the caller guarantees that all coordinates are unique, i.e. no two coordinates are within eps from each other
+     * or from any vertex already added, the search for existing vertices is skipped and the storage is allocated once for
+     * all vertices. Otherwise, each coordinate is added using AddVertex.
+     *
+     * @param Coordinates Coordinates stored as x0, y0, z0, x1, y1, ...
+     * @param NumberOfVertices Number of vertices
+     * @param Unique True if the coordinates are known to be unique
+     * @return Index of the first vertex. If Unique is true, vertex i is given index [return value]+i.
+     */
+    int AddVertices(const double *Coordinates, size_t NumberOfVertices, bool Unique);
+
+    /**
+     * @brief Find a vertex in the structure by coordinate. If a vertex at the specified coordinate exists, return a pointer to that vertex object.
+     * @param x X coordinate
+     * @param y Y coordinate
+     * @param z Z coordinate
+     * @return Pointer to vertex object or NULL if not found
+     */
+    VertexType *FindVertexByCoords(double x, double y, double z) const;
+
+    /**
+     * @brief Produce a list of vertices which are located within a sphere
+     * @param x Center X coordinate of sphere
+     * @param y Center Y coordinate of sphere
+     * @param z Center Z coordinate of sphere
+     * @param r Radius of sphere
+     * @return List of vertices
+     */
+    std :: vector< VertexType * >GiveVerticesWithinSphere(double x, double y, double z, double r) const;
+
+    /**
+     * @brief Finds all vertices located within a sphere. The list is cleared before the vertices are added, but its
+     * capacity is kept, thus the same list can be reused between queries without allocating memory.
+     * @param x Center X coordinate of sphere
+     * @param y Center Y coordinate of sphere
+     * @param z Center Z coordinate of sphere
+     * @param r Radius of sphere
+     * @param Result [out] List of vertices
+     */
+    void GiveVerticesWithinSphere(double x, double y, double z, double r, std :: vector< VertexType * > &Result) const;
+
+    /**
+     * @brief Removes a vertex from the structure. The vertex remains in the list of vertices but is no longer found by
+     * any query. Nothing happens if the vertex is already removed.
+     * @param VertexID Index of vertex
+     */
+    void RemoveVertex(int VertexID);
+
+    /**
+     * @brief Moves a vertex to the cell of its current position. Call this after the coordinates of the vertex have
+     * been changed.
+     * @param VertexID Index of vertex
+     */
+    void MoveVertex(int VertexID);
+
+    /**
+     * @brief Rehashes all vertices, except those removed, by their current positions. This is cheaper than calling
+     * MoveVertex for each vertex when a large part of the vertices has been moved.
+     */
+    void Rebuild();
+
+    /**
+     * @brief Update the vertex indices after the list of vertices has been reordered
+     * @param NewIndices NewIndices[i] is the new index of the vertex previously stored at index i
+     */
+    void RenumberVertices(std :: vector< int > &NewIndices);
+
+    /**
+     * @brief Print all occupied cells and the vertices therein.
+     */
+    void printself();
+};
+}
+#endif // VERTEXHASHGRID_H
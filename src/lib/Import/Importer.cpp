@@ -1,6 +1,22 @@
+#include <stdlib.h>
+
 #include "Importer.h"
+#include "MiscFunctions.h"
 
 namespace voxel2tet {
+Importer :: ~Importer()
+{
+    this->ReleaseData();
+}
+
+void Importer :: ReleaseData()
+{
+    if ( this->GrainIdsData != NULL ) {
+        free(this->GrainIdsData);
+        this->GrainIdsData = NULL;
+    }
+}
+
 void Importer :: GiveDimensions(int dimensions [ 3 ])
 {
     for ( int i = 0; i < 3; i++ ) {
@@ -71,6 +87,11 @@ int Importer :: GiveMaterialIDByIndex(int xi, int yi, int zi)
         zi=zi+this->CutOut.minvalues[2];
     }
 
+    if ( this->GrainIdsData == NULL ) {
+        STATUS("Voxel data is not available (not loaded or already released)\n", 0);
+        throw( 0 );
+    }
+
     int index = zi * this->dimensions_data [ 1 ] * this->dimensions_data [ 0 ] + yi * this->dimensions_data [ 0 ] + xi;
     return this->GrainIdsData [ index ];
 }
@@ -88,7 +88,8 @@ protected:
 
 public:
 
-    Importer() {UseCutOut = false; }
+    Importer() {UseCutOut = false; GrainIdsData = NULL; }
+    virtual ~Importer();
 
     bool UseCutOut;
 
@@ -104,6 +105,15 @@ public:
      */
     virtual void LoadFile(std :: string FileName) = 0;
 
+    /**
+     * @brief Frees the voxel data.
+     *
+     * Once the topology (surfaces and phase edges) has been extracted, the voxel data is no longer needed and the memory can be
+     * released. Subsequent calls to GiveMaterialIDByIndex and GiveMaterialIDByCoordinate throws an exception while dimensions,
+     * spacing, origin and bounding box are still available.
+     */
+    virtual void ReleaseData();
+
     /**
      * @brief Returns the identifier of the material located at coordinate (x, y, z).
      * @param x X coordinate
@@ -0,0 +1,99 @@
+#include "LaplacianSmoother.h"
+
+namespace voxel2tet
+{
+
+LaplacianSmoother::LaplacianSmoother(double VoxelCharLength, double limit_factor, int max_iterations) : Smoother ()
+{
+    this->charlength = VoxelCharLength;
+    this->limit_factor = limit_factor;
+    this->max_iterations = max_iterations;
+}
+
+void LaplacianSmoother::PrintParameters(std :: ostream &stream) const
+{
+    stream << "\tConstrained Laplacian smoother\n";
+    stream << "\tlimit_factor = " << this->limit_factor << ", max_iterations = " << this->max_iterations << "\n";
+}
+
+void LaplacianSmoother::Smooth(std :: vector< VertexType * >Vertices, MeshData *Mesh)
+{
+    std :: chrono :: steady_clock :: time_point starttime = std :: chrono :: steady_clock :: now();
+
+    std :: vector< VertexType * >LocalVertices;
+    std :: vector< int >ConnectionStart;
+    std :: vector< int >ConnectionIndex;
+    this->GetConnectivity(Vertices, LocalVertices, ConnectionStart, ConnectionIndex);
+
+    std :: vector< std :: array< double, 3 > >OriginalPositions( LocalVertices.size() );
+    for ( size_t i = 0; i < LocalVertices.size(); i++ ) {
+        OriginalPositions [ i ] = LocalVertices [ i ]->get_c();
+    }
+    std :: vector< std :: array< double, 3 > >CurrentPositions = OriginalPositions;
+    std :: vector< std :: array< double, 3 > >PreviousPositions = OriginalPositions;
+
+    const double limit = this->charlength * this->limit_factor;
+    int n = Vertices.size();
+    int itercount = 0;
+    double deltamax = 1e8;
+
+    while ( ( itercount < this->max_iterations ) & ( deltamax > ( charlength * 1e-3 ) ) ) {
+        // Only positions of Vertices change, thus the others remain the same
+        std :: copy( CurrentPositions.begin(), CurrentPositions.begin() + n, PreviousPositions.begin() );
+        deltamax = 0.0;
+
+#pragma omp parallel for reduction(max:deltamax)
+        for ( int i = 0; i < n; i++ ) {
+            int NumberOfConnections = ConnectionStart [ i + 1 ] - ConnectionStart [ i ];
+            if ( NumberOfConnections == 0 ) {
+                continue;
+            }
+
+            // Move to the mean of the connected vertices
+            std :: array< double, 3 >Mean = { { 0.0, 0.0, 0.0 } };
+            for ( int k = ConnectionStart [ i ]; k < ConnectionStart [ i + 1 ]; k++ ) {
+                for ( int j = 0; j < 3; j++ ) {
+                    Mean [ j ] = Mean [ j ] + PreviousPositions [ ConnectionIndex [ k ] ] [ j ];
+                }
+            }
+            std :: array< double, 3 >x = PreviousPositions [ i ];
+            for ( int j = 0; j < 3; j++ ) {
+                if ( !Vertices [ i ]->Fixed [ j ] ) {
+                    x [ j ] = Mean [ j ] / NumberOfConnections;
+                }
+            }
+
+            // Project back onto the sphere around the original position
+            double d = 0.0;
+            for ( int j = 0; j < 3; j++ ) {
+                d = d + ( x [ j ] - OriginalPositions [ i ] [ j ] ) * ( x [ j ] - OriginalPositions [ i ] [ j ] );
+            }
+            d = std :: sqrt(d);
+            if ( d > limit ) {
+                for ( int j = 0; j < 3; j++ ) {
+                    x [ j ] = OriginalPositions [ i ] [ j ] + ( x [ j ] - OriginalPositions [ i ] [ j ] ) * limit / d;
+                }
+            }
+
+            double delta = 0.0;
+            for ( int j = 0; j < 3; j++ ) {
+                delta = delta + ( x [ j ] - PreviousPositions [ i ] [ j ] ) * ( x [ j ] - PreviousPositions [ i ] [ j ] );
+            }
+            deltamax = std :: max( deltamax, std :: sqrt(delta) );
+            CurrentPositions [ i ] = x;
+        }
+
+        itercount++;
+    }
+
+    if ( deltamax > ( charlength * 1e-3 ) ) {
+        STATUS("\tConstrained Laplacian smoothing stopped after %u iterations with deltamax=%f\n", itercount, deltamax);
+    }
+
+    this->UpdateAndRepair(Vertices, CurrentPositions, OriginalPositions, Mesh);
+
+    double time = std :: chrono :: duration< double >(std :: chrono :: steady_clock :: now() - starttime).count();
+    this->AddStatistics(Vertices, OriginalPositions, itercount, time);
+}
+
+}
@@ -0,0 +1,46 @@
+#ifndef LAPLACIANSMOOTHER_H
+#define LAPLACIANSMOOTHER_H
+
+#include <vector>
+#include <array>
+#include <chrono>
+
+#include "MeshComponents.h"
+#include "MeshData.h"
+#include "Smoother.h"
+
+namespace voxel2tet
+{
+
+/**
+ * @brief Provides constrained Laplacian smoothing.
+ *
+ * In each iteration, each vertex is moved to the mean of its connected vertices. If this moves the vertex farther than
+ * a given distance from its original position, it is moved back onto the sphere with that radius. The constraint
+ * prevents the shrinkage of unconstrained Laplacian smoothing from wiping out small features, at the cost of less
+ * smooth surfaces than spring smoothing.
+ */
+class LaplacianSmoother : public Smoother
+{
+private:
+    double charlength;
+    double limit_factor;
+    int max_iterations;
+
+    void PrintParameters(std :: ostream &stream) const;
+
+public:
+    /**
+     * @brief Constructor
+     * @param VoxelCharLength Charachteristic length of a voxel
+     * @param limit_factor Largest distance of a vertex from its original position as a factor of VoxelCharLength
+     * @param max_iterations Largest number of iterations
+     */
+    LaplacianSmoother(double VoxelCharLength, double limit_factor, int max_iterations);
+    ~LaplacianSmoother() {}
+
+    void Smooth(std :: vector< VertexType * >Vertices, MeshData *Mesh = NULL);
+};
+
+}
+#endif
@@ -21,7 +21,9 @@ VertexType :: VertexType(double x, double y, double z)
 
 void VertexType :: set_c(std :: array< double, 3 >newc)
 {
-    this->c = newc;
+    for ( int i = 0; i < 3; i++ ) {
+        this->c [ i ] = newc [ i ];
+    }
     for ( TriangleType *t : this->Triangles ) {
         t->UpdateNormal();
     }
@@ -37,7 +39,7 @@ void VertexType :: set_c(double c, int index)
 
 std :: array< double, 3 >VertexType :: get_c()
 {
-    return this->c;
+    return { { this->c [ 0 ], this->c [ 1 ], this->c [ 2 ] } };
 }
 
 double VertexType :: get_c(int index)
@@ -12,6 +12,18 @@ class TriangleType;
 class EdgeType;
 class PhaseEdge;
 
+/**
+ * @brief Floating point type used for storing coordinates and normals.
+ *
+ * If compiled with SINGLE_PRECISION, coordinates are stored as float to reduce the memory footprint of large
+ * meshes. All computations (get_c, normals, intersection tests etc.) are still carried out in double precision.
+ */
+#ifdef SINGLE_PRECISION
+typedef float CoordinateType;
+#else
+typedef double CoordinateType;
+#endif
+
 /**
  * @brief The VertexType class provides information relevant to one vertex in the mesh.
  *
@@ -23,7 +35,7 @@ class PhaseEdge;
 class VertexType
 {
 private:
-    std :: array< double, 3 >c;
+    std :: array< CoordinateType, 3 >c;
 
 public:
     /**
@@ -85,7 +97,7 @@ public:
     /**
      * @brief Contains the original coordinates before smoothing.
      */
-    double originalcoordinates [ 3 ];
+    CoordinateType originalcoordinates [ 3 ];
 
     /**
      * @brief Update coordinates of this vertex
@@ -221,7 +233,7 @@ private:
     std :: array< double, 3 >GiveEdgeVector(int node);
 
     // Normal of element
-    std :: array< double, 3 >Normal;
+    std :: array< CoordinateType, 3 >Normal;
 public:
 
     /**
@@ -325,7 +337,7 @@ public:
      *
      * @return Array of doubles describing the normal
      */
-    std :: array< double, 3 >GiveNormal() { return Normal; }
+    std :: array< double, 3 >GiveNormal() { return { { Normal [ 0 ], Normal [ 1 ], Normal [ 2 ] } }; }
 
     /**
      * @brief Gives normalized normal. See GiveNormal().
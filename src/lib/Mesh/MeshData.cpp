@@ -11,9 +11,10 @@ namespace voxel2tet
 MeshData :: MeshData(BoundingBoxType BoundingBox)
 {
     this->BoundingBox = BoundingBox;
-    this->VertexOctreeRoot = new VertexOctreeNode(this->BoundingBox, & this->Vertices, 0);
+    this->VertexGrid = new VertexHashGrid(this->BoundingBox, & this->Vertices);
     this->TriangleCounter = 0;
     this->EdgeCounter = 0;
+    this->TriangleTreeBuilt = false;
 }
 
 MeshData :: ~MeshData()
@@ -34,210 +35,271 @@ MeshData :: ~MeshData()
         delete t;
     }
 
-    delete this->VertexOctreeRoot;
+    delete this->VertexGrid;
 }
 
 void MeshData :: DoSanityCheck()
 {
-    // Check edge for duplicates and make sure that each edge conatins two unique vertices
-    for (size_t i=0; i<this->Edges.size(); i++) {
-        EdgeType *e1 = this->Edges[i];
-        if (e1->Vertices[0]==e1->Vertices[1]) {
-            LOG ("Edge is a point\n", 0);
-            throw(0);
-        }
-        for (size_t j=i+1; j<this->Edges.size(); j++) {
-            EdgeType *e2 = this->Edges[j];
-            if ( ( (e1->Vertices[0]==e2->Vertices[0]) & (e1->Vertices[1]==e2->Vertices[1]) ) |
-                 ( (e1->Vertices[0]==e2->Vertices[1]) & (e1->Vertices[1]==e2->Vertices[0]) ) ) {
-                LOG("Duplicate edge! %u@%p (%u, %u) and %u@%p (%u, %u)\n", e1->ID, e1, e1->Vertices[0]->ID, e1->Vertices[1]->ID, e2->ID, e2, e2->Vertices[0]->ID, e2->Vertices[1]->ID );
-                throw(0);
-            }
+    if ( !this->ValidateMesh() ) {
+        LOG("Sanity check failed\n", 0);
+        throw( 0 );
+    }
+
+    LOG("DoSanityCheck finished\n", 0);
+}
+
+/**
+ * @brief Hash function for canonical keys made up of pointers and integers
+ */
+template< std :: size_t N >
+struct MeshKeyHash {
+    std :: size_t operator()(const std :: array< uintptr_t, N > &Key) const
+    {
+        std :: size_t h = 0;
+        for ( uintptr_t k : Key ) {
+            h ^= std :: hash< uintptr_t >()(k) + 0x9e3779b9 + ( h << 6 ) + ( h >> 2 );
         }
+        return h;
     }
+};
 
-    // Check list of edges and triangles and ensure that each edge at least holds two triangles
-/*    bool EdgeMissing = false;
-    for (TriangleType *t: this->Triangles) {
-        for (int i=0; i<3; i++) {
-            EdgeType te;
-            te.Vertices[0] = t->Vertices[i];
-            te.Vertices[1] = ( i<2 ? t->Vertices[i+1] : t->Vertices[0]);
+typedef std :: array< uintptr_t, 2 >EdgeKey;
+typedef std :: array< uintptr_t, 3 >TriangleKey;
 
-            bool EdgeFound = false;
-            for (EdgeType *e: this->Edges) {
-                if ( ((e->Vertices[0]==te.Vertices[0]) & (e->Vertices[1]==te.Vertices[1])) | ((e->Vertices[0]==te.Vertices[1]) & (e->Vertices[1]==te.Vertices[0]))) {
+static EdgeKey GiveEdgeKey(VertexType *v0, VertexType *v1)
+{
+    uintptr_t a = reinterpret_cast< uintptr_t >(v0);
+    uintptr_t b = reinterpret_cast< uintptr_t >(v1);
+    return { { std :: min(a, b), std :: max(a, b) } };
+}
 
-                    std :: vector< TriangleType * > ConnectedTriangles = e->GiveTriangles();
-                    if (ConnectedTriangles.size()<2) {
-                        LOG("To few triangles\n", 0);
-                        throw (0);
-                    }
+bool MeshData :: ValidateMesh()
+{
+    int ErrorCount = 0;
+    int NonManifoldCount = 0;
 
-                    EdgeFound = true;
-                    break;
-                }
-            }
+    std :: unordered_set< VertexType * >VertexSet( this->Vertices.begin(), this->Vertices.end() );
+    std :: unordered_set< TriangleType * >TriangleSet( this->Triangles.begin(), this->Triangles.end() );
+    std :: unordered_set< EdgeType * >EdgeSet( this->Edges.begin(), this->Edges.end() );
 
-            if (!EdgeFound) {
-                EdgeMissing = true;
-                LOG("\tTriangle %u, edge %u\n", t->ID, i);
+    // Edges: degenerate, duplicates and incidence
+    std :: unordered_set< EdgeKey, MeshKeyHash< 2 > >EdgeKeys;
+    EdgeKeys.reserve( this->Edges.size() );
+    for ( EdgeType *e : this->Edges ) {
+        if ( e->Vertices [ 0 ] == e->Vertices [ 1 ] ) {
+            STATUS("Edge %u is a point\n", e->ID);
+            ErrorCount++;
+            continue;
+        }
+        if ( !EdgeKeys.insert( GiveEdgeKey(e->Vertices [ 0 ], e->Vertices [ 1 ]) ).second ) {
+            STATUS("Duplicate edge %u (%u, %u)\n", e->ID, e->Vertices [ 0 ]->ID, e->Vertices [ 1 ]->ID);
+            ErrorCount++;
+        }
+        for ( VertexType *v : e->Vertices ) {
+            if ( VertexSet.find(v) == VertexSet.end() ) {
+                STATUS("Edge %u refers to vertex not in mesh\n", e->ID);
+                ErrorCount++;
+            } else if ( std :: find(v->Edges.begin(), v->Edges.end(), e) == v->Edges.end() ) {
+                STATUS("Edge %u not known by vertex %u\n", e->ID, v->ID);
+                ErrorCount++;
             }
-
         }
-
     }
 
-    if (EdgeMissing) {
-        throw (0);
-    }*/
+    // Triangles: degenerate, duplicates, incidence and existence of edges
+    std :: unordered_set< TriangleKey, MeshKeyHash< 3 > >TriangleKeys;
+    TriangleKeys.reserve( this->Triangles.size() );
 
-    /*
-    // Check if vertices in triangles are the same as vertices in edges
-    std::vector<VertexType *> VerticesTriangles;
-    std::vector<VertexType *> VerticesEdges;
+    // For each edge on each interface, store the triangles and if the edge is traversed from the lower to the higher pointer
+    std :: unordered_map< TriangleKey, std :: vector< std :: pair< TriangleType *, bool > >, MeshKeyHash< 3 > >InterfaceEdges;
+    InterfaceEdges.reserve( this->Triangles.size() * 3 / 2 );
 
-    for (TriangleType *t: this->Triangles) {
-        for (int i=0; i<3; i++) {
-            VerticesTriangles.push_back( t->Vertices[i] );
+    for ( TriangleType *t : this->Triangles ) {
+        TriangleKey Key;
+        for ( int i = 0; i < 3; i++ ) {
+            Key [ i ] = reinterpret_cast< uintptr_t >(t->Vertices [ i ]);
         }
-    }
+        std :: sort( Key.begin(), Key.end() );
 
-    for (EdgeType *e: this->Edges) {
-        for (int i=0; i<2; i++) {
-            VerticesEdges.push_back(e->Vertices[i]);
+        if ( ( Key [ 0 ] == Key [ 1 ] ) | ( Key [ 1 ] == Key [ 2 ] ) ) {
+            STATUS("Triangle %u is degenerate\n", t->ID);
+            ErrorCount++;
+            continue;
+        }
+        if ( !TriangleKeys.insert(Key).second ) {
+            STATUS("Duplicate triangle %u (%u, %u, %u)\n", t->ID, t->Vertices [ 0 ]->ID, t->Vertices [ 1 ]->ID, t->Vertices [ 2 ]->ID);
+            ErrorCount++;
         }
-    }
-
-    std :: sort( VerticesTriangles.begin(), VerticesTriangles.end() );
-    VerticesTriangles.erase( std :: unique( VerticesTriangles.begin(), VerticesTriangles.end() ), VerticesTriangles.end() );
-
-    std :: sort( VerticesEdges.begin(), VerticesEdges.end() );
-    VerticesEdges.erase( std :: unique( VerticesEdges.begin(), VerticesEdges.end() ), VerticesEdges.end() );
-
-    if (VerticesEdges.size() != VerticesTriangles.size()) {
-        STATUS("Set of vertices in edges and set of vertices in triangles differ\n", 0);
-
-        std::vector<VertexType *> InTriNotEdges;
-        std::set_difference(VerticesTriangles.begin(), VerticesTriangles.end(), VerticesEdges.begin(), VerticesEdges.end(), std::inserter(InTriNotEdges, InTriNotEdges.end()));
-        LOG("Vertices in triangles not on any edge:\n", 0);
-        for (VertexType *v: InTriNotEdges) {LOG("\t%u\n", v->ID);}
 
-        std::vector<VertexType *> OnEdgesNotTri;
-        std::set_difference(VerticesEdges.begin(), VerticesEdges.end(), VerticesTriangles.begin(), VerticesTriangles.end(), std::inserter(OnEdgesNotTri, OnEdgesNotTri.end()));
-        LOG("Vertices on edge not in any triangle:\n", 0);
-        for (VertexType *v: OnEdgesNotTri) {LOG("\t%u\n", v->ID);}
+        for ( int i = 0; i < 3; i++ ) {
+            VertexType *v = t->Vertices [ i ];
+            VertexType *vnext = t->Vertices [ ( i == 2 ) ? 0 : i + 1 ];
 
-        throw(0);
-    } */
+            if ( VertexSet.find(v) == VertexSet.end() ) {
+                STATUS("Triangle %u refers to vertex not in mesh\n", t->ID);
+                ErrorCount++;
+            } else if ( std :: find(v->Triangles.begin(), v->Triangles.end(), t) == v->Triangles.end() ) {
+                STATUS("Triangle %u not known by vertex %u\n", t->ID, v->ID);
+                ErrorCount++;
+            }
 
-/*
-    // Does the list of triangles vertices correspond to the list of vertices triangles?
-    for ( TriangleType *t : this->Triangles ) {
-        bool TriangleFound = false;
-        for ( VertexType *v : t->Vertices ) {
-            for ( TriangleType *vt : v->Triangles ) {
-                if ( vt == t ) {
-                    TriangleFound = true;
-                }
+            EdgeKey ek = GiveEdgeKey(v, vnext);
+            if ( EdgeKeys.find(ek) == EdgeKeys.end() ) {
+                STATUS("Edge (%u, %u) of triangle %u is missing\n", v->ID, vnext->ID, t->ID);
+                ErrorCount++;
             }
-        }
-        if ( !TriangleFound ) {
-            STATUS("Triangles and vertices does not match!\n", 0);
-            throw 0;
-        }
-        if ( t->ID > this->TriangleCounter ) {
-            STATUS("Invalid triangle ID!\n", 0);
-            throw 0;
+
+            TriangleKey iek = { { ek [ 0 ], ek [ 1 ], uintptr_t(t->InterfaceID) } };
+            InterfaceEdges [ iek ].push_back({ t, reinterpret_cast< uintptr_t >(v) == ek [ 0 ] });
         }
     }
 
-    // Does the list of edge vertices correspond to the list of vertices triangles?
-    for ( EdgeType *e : this->Edges ) {
-        bool EdgeFound = false;
-        for ( VertexType *v : e->Vertices ) {
-            for ( EdgeType *ve : v->Edges ) {
-                if ( ve == e ) {
-                    EdgeFound = true;
-                }
+    // Manifoldness and orientation per interface
+    for ( auto &ie : InterfaceEdges ) {
+        std :: vector< std :: pair< TriangleType *, bool > > &EdgeTriangles = ie.second;
+        if ( EdgeTriangles.size() > 2 ) {
+            LOG("Edge shared by %zu triangles on interface %u\n", EdgeTriangles.size(), EdgeTriangles [ 0 ].first->InterfaceID);
+            NonManifoldCount++;
+        } else if ( EdgeTriangles.size() == 2 ) {
+            TriangleType *t1 = EdgeTriangles [ 0 ].first;
+            TriangleType *t2 = EdgeTriangles [ 1 ].first;
+            bool OppositeTraversal = EdgeTriangles [ 0 ].second != EdgeTriangles [ 1 ].second;
+            bool SamePositiveSide = t1->PosNormalMatID == t2->PosNormalMatID;
+            if ( OppositeTraversal != SamePositiveSide ) {
+                STATUS("Triangles %u and %u on interface %u are inconsistently oriented\n", t1->ID, t2->ID, t1->InterfaceID);
+                ErrorCount++;
             }
         }
-        if ( !EdgeFound ) {
-            STATUS("Edges and vertices does not match!\n", 0);
-            throw 0;
-        }
     }
 
-    // Check the same, but for vertices
+    // Vertices: incidence in the other direction
     for ( VertexType *v : this->Vertices ) {
-        bool VertexFoundInTriangle = ( v->Triangles.size() == 0 ) ? true : false;
-
         for ( TriangleType *t : v->Triangles ) {
-            for ( VertexType *vt : t->Vertices ) {
-                if ( vt == v ) {
-                    VertexFoundInTriangle = true;
-                }
+            if ( TriangleSet.find(t) == TriangleSet.end() ) {
+                STATUS("Vertex %u refers to triangle not in mesh\n", v->ID);
+                ErrorCount++;
+            } else if ( std :: find(t->Vertices.begin(), t->Vertices.end(), v) == t->Vertices.end() ) {
+                STATUS("Vertex %u refers to triangle %u which does not contain the vertex\n", v->ID, t->ID);
+                ErrorCount++;
             }
         }
-
-        if ( !VertexFoundInTriangle ) {
-            STATUS("Triangle does not contain vertex while vertex contains triangle\n", 0);
-            throw 0;
-        }
-
-        bool VertexFoundInEdge = ( v->Edges.size() == 0 ) ? true : false;
-
         for ( EdgeType *e : v->Edges ) {
-            for ( VertexType *ve : e->Vertices ) {
-                if ( ve == v ) {
-                    VertexFoundInEdge = true;
-                }
+            if ( EdgeSet.find(e) == EdgeSet.end() ) {
+                STATUS("Vertex %u refers to edge not in mesh\n", v->ID);
+                ErrorCount++;
+            } else if ( ( e->Vertices [ 0 ] != v ) & ( e->Vertices [ 1 ] != v ) ) {
+                STATUS("Vertex %u refers to edge %u which does not contain the vertex\n", v->ID, e->ID);
+                ErrorCount++;
             }
         }
+    }
 
-        if ( !VertexFoundInEdge ) {
-            STATUS("Vertex not found in edge list while edge is found in vertex list of edges\n", 0);
-            throw 0;
-        }
+    if ( NonManifoldCount > 0 ) {
+        STATUS("Mesh validation: %u non-manifold interface edges\n", NonManifoldCount);
     }
 
+    if ( ErrorCount > 0 ) {
+        STATUS("Mesh validation failed with %u errors\n", ErrorCount);
+        return false;
+    }
 
-    // Are all triangles unique?
-    for ( TriangleType *t1 : this->Triangles ) {
-        for ( TriangleType *t2 : this->Triangles ) {
-            if ( t1 != t2 ) {
-                bool ispermutation = std :: is_permutation( t1->Vertices.begin(), t1->Vertices.end(), t2->Vertices.begin() );
-                if ( ispermutation ) {
-                    STATUS("\nDuplicate triangles\n", 0);
-                    throw 0;
-                }
-            }
+    return true;
+}
+
+uint64_t MeshData :: GiveMortonCode(std :: array< double, 3 >c)
+{
+    uint64_t Code = 0;
+    uint64_t Quantized [ 3 ];
+
+    for ( int i = 0; i < 3; i++ ) {
+        double Length = this->BoundingBox.maxvalues [ i ] - this->BoundingBox.minvalues [ i ];
+        double s = ( Length > 0.0 ) ? ( c [ i ] - this->BoundingBox.minvalues [ i ] ) / Length : 0.0;
+        // Smoothing may move vertices slightly outside the original bounding box
+        s = std :: min( std :: max(s, 0.0), 1.0 );
+        Quantized [ i ] = uint64_t( s * double( ( 1 << 21 ) - 1 ) );
+    }
+
+    for ( int bit = 0; bit < 21; bit++ ) {
+        for ( int i = 0; i < 3; i++ ) {
+            Code |= ( ( Quantized [ i ] >> bit ) & 1 ) << ( 3 * bit + i );
         }
-    }*/
+    }
 
-    LOG("DoSanityCheck finished\n", 0);
+    return Code;
+}
 
+void MeshData :: ReorderMesh()
+{
+    STATUS("Reorder mesh along space filling curve\n", 0);
+
+    // Sort vertices
+    std :: vector< std :: pair< uint64_t, int > >VertexCodes;
+    VertexCodes.reserve( this->Vertices.size() );
+    for ( size_t i = 0; i < this->Vertices.size(); i++ ) {
+        VertexCodes.push_back({ this->GiveMortonCode( this->Vertices [ i ]->get_c() ), i });
+    }
+    std :: stable_sort( VertexCodes.begin(), VertexCodes.end() );
+
+    std :: vector< int >NewIndices( this->Vertices.size() );
+    std :: vector< VertexType * >SortedVertices;
+    SortedVertices.reserve( this->Vertices.size() );
+    for ( size_t i = 0; i < VertexCodes.size(); i++ ) {
+        VertexType *v = this->Vertices [ VertexCodes [ i ].second ];
+        NewIndices [ VertexCodes [ i ].second ] = i;
+        v->ID = i;
+        SortedVertices.push_back(v);
+    }
+    this->Vertices.swap(SortedVertices);
+    this->VertexGrid->RenumberVertices(NewIndices);
+
+    // Sort triangles by center of mass
+    std :: vector< std :: pair< uint64_t, TriangleType * > >TriangleCodes;
+    TriangleCodes.reserve( this->Triangles.size() );
+    for ( TriangleType *t : this->Triangles ) {
+        TriangleCodes.push_back({ this->GiveMortonCode( t->GiveCenterOfMass() ), t });
+    }
+    std :: stable_sort( TriangleCodes.begin(), TriangleCodes.end(), [](const std :: pair< uint64_t, TriangleType * > &a, const std :: pair< uint64_t, TriangleType * > &b) {
+        return a.first < b.first;
+    });
+
+    for ( size_t i = 0; i < TriangleCodes.size(); i++ ) {
+        this->Triangles [ i ] = TriangleCodes [ i ].second;
+        this->Triangles [ i ]->ID = i;
+    }
+    this->TriangleCounter = this->Triangles.size();
+}
+
+MeshSnapshot *MeshData :: CreateSnapshot()
+{
+    return new MeshSnapshot(& this->Triangles, & this->Vertices, & this->Edges, & this->Tets);
 }
 
 void MeshData :: ExportSurface(std :: string FileName, Exporter_FileTypes FileType)
+{
+    MeshSnapshot *Snapshot = this->CreateSnapshot();
+    this->ExportSurface(FileName, FileType, Snapshot);
+    delete Snapshot;
+}
+
+void MeshData :: ExportSurface(std :: string FileName, Exporter_FileTypes FileType, MeshSnapshot *Snapshot)
 {
     STATUS( "Export surface to %s\n", FileName.c_str() );
     Exporter *exporter;
     switch ( FileType ) {
     case FT_OFF: {
-        exporter = new OFFExporter(& this->Triangles, & this->Vertices, & this->Edges, & this->Tets);
+        exporter = new OFFExporter(Snapshot);
         break;
     }
     case FT_Poly: {
-        exporter = new TetGenExporter(& this->Triangles, & this->Vertices, & this->Edges, & this->Tets);
+        exporter = new TetGenExporter(Snapshot);
         break;
     }
     case FT_VTK: {
-        exporter = new VTKExporter(& this->Triangles, & this->Vertices, & this->Edges, & this->Tets);
+        exporter = new VTKExporter(Snapshot);
         break;
     }
     case FT_SIMPLE: {
-        exporter = new SimpleExporter(& this->Triangles, & this->Vertices, & this->Edges, & this->Tets);
+        exporter = new SimpleExporter(Snapshot);
         break;
     }
     default: {
@@ -246,32 +308,39 @@ void MeshData :: ExportSurface(std :: string FileName, Exporter_FileTypes FileTy
     }
     }
     exporter->WriteSurfaceData(FileName);
-    free(exporter);
+    delete exporter;
 }
 
 void MeshData :: ExportVolume(std :: string FileName, Exporter_FileTypes FileType)
+{
+    MeshSnapshot *Snapshot = this->CreateSnapshot();
+    this->ExportVolume(FileName, FileType, Snapshot);
+    delete Snapshot;
+}
+
+void MeshData :: ExportVolume(std :: string FileName, Exporter_FileTypes FileType, MeshSnapshot *Snapshot)
 {
     STATUS( "Export volume to %s\n", FileName.c_str() );
     Exporter *exporter;
     switch ( FileType ) {
     case FT_OFF: {
-        exporter = new OFFExporter(& this->Triangles, & this->Vertices, & this->Edges, & this->Tets);
+        exporter = new OFFExporter(Snapshot);
         break;
     }
     case FT_Poly: {
-        exporter = new TetGenExporter(& this->Triangles, & this->Vertices, & this->Edges, & this->Tets);
+        exporter = new TetGenExporter(Snapshot);
         break;
     }
     case FT_VTK: {
-        exporter = new VTKExporter(& this->Triangles, & this->Vertices, & this->Edges, & this->Tets);
+        exporter = new VTKExporter(Snapshot);
         break;
     }
     case FT_OOFEM: {
-        exporter = new OOFEMExporter(& this->Triangles, & this->Vertices, & this->Edges, & this->Tets);
+        exporter = new OOFEMExporter(Snapshot);
         break;
     }
     case FT_ABAQUS: {
-        exporter = new AbaqusExporter(& this->Triangles, & this->Vertices, & this->Edges, & this->Tets);
+        exporter = new AbaqusExporter(Snapshot);
         break;
     }
     default:
@@ -279,7 +348,7 @@ void MeshData :: ExportVolume(std :: string FileName, Exporter_FileTypes FileTyp
         return;
     }
     exporter->WriteVolumeData(FileName);
-    free(exporter);
+    delete exporter;
 }
 
 EdgeType *MeshData :: AddEdge(std::array<int, 2> VertexIDs)
@@ -338,6 +407,9 @@ void MeshData :: RemoveEdge(EdgeType *e)
 void MeshData :: RemoveTriangle(TriangleType *t)
 {
     LOG("Remove triangle %u\n", t->ID);
+    if ( this->TriangleTreeBuilt ) {
+        this->TriangleTree.Remove(t);
+    }
     for ( VertexType *v : t->Vertices ) {
         v->RemoveTriangle(t);
     }
@@ -351,9 +423,9 @@ TriangleType *MeshData :: AddTriangle(std :: array< double, 3 >v0, std :: array<
     // Insert vertices and create a triangle using the indices returned
     int VertexIDs [ 3 ];
 
-    VertexIDs [ 0 ] = this->VertexOctreeRoot->AddVertex(v0 [ 0 ], v0 [ 1 ], v0 [ 2 ]);
-    VertexIDs [ 1 ] = this->VertexOctreeRoot->AddVertex(v1 [ 0 ], v1 [ 1 ], v1 [ 2 ]);
-    VertexIDs [ 2 ] = this->VertexOctreeRoot->AddVertex(v2 [ 0 ], v2 [ 1 ], v2 [ 2 ]);
+    VertexIDs [ 0 ] = this->VertexGrid->AddVertex(v0 [ 0 ], v0 [ 1 ], v0 [ 2 ]);
+    VertexIDs [ 1 ] = this->VertexGrid->AddVertex(v1 [ 0 ], v1 [ 1 ], v1 [ 2 ]);
+    VertexIDs [ 2 ] = this->VertexGrid->AddVertex(v2 [ 0 ], v2 [ 1 ], v2 [ 2 ]);
 
     return this->AddTriangle({ VertexIDs [ 0 ], VertexIDs [ 1 ], VertexIDs [ 2 ] });
 }
@@ -384,16 +456,16 @@ TriangleType *MeshData :: AddTriangle(std :: array< int, 3 >VertexIDs)
 TriangleType *MeshData :: AddTriangle(TriangleType *NewTriangle)
 {
 #if SANITYCHECK == 1
-    int i = 0;
-    for ( TriangleType *t : this->Triangles ) {
+    // A duplicate triangle shares all vertices, thus it suffices to check the triangles of one vertex
+    for ( TriangleType *t : NewTriangle->Vertices [ 0 ]->Triangles ) {
+        if ( t == NewTriangle ) {
+            continue;
+        }
         bool permutation = std :: is_permutation( t->Vertices.begin(), t->Vertices.end(), NewTriangle->Vertices.begin() );
         if ( permutation ) {
-            STATUS("\nTriangle already exist. Existing ID = %u (index %u in list)!\n", t->ID, i); //TODO: Add a logging command for errors
+            STATUS("\nTriangle already exist. Existing ID = %u!\n", t->ID); //TODO: Add a logging command for errors
             return t;
-
-            throw 0;
         }
-        i++;
     }
 #endif
 
@@ -410,6 +482,9 @@ TriangleType *MeshData :: AddTriangle(TriangleType *NewTriangle)
     }
     TriangleCounter++;
     this->Triangles.push_back(NewTriangle);
+    if ( this->TriangleTreeBuilt ) {
+        this->TriangleTree.Insert(NewTriangle);
+    }
     return NewTriangle;
 }
 
@@ -435,21 +510,149 @@ void MeshData :: RemoveTetragedron(TetType *t)
 
 std :: vector< TriangleType * >MeshData :: GetTrianglesAround(std :: array< double, 3 >c, double r)
 {
-    std :: vector< VertexType * >NearVertices = this->VertexOctreeRoot->GiveVerticesWithinSphere(c [ 0 ], c [ 1 ], c [ 2 ], r);
-    std :: sort( NearVertices.begin(), NearVertices.end() );
-    NearVertices.erase( std :: unique( NearVertices.begin(), NearVertices.end() ), NearVertices.end() );
     std :: vector< TriangleType * >NearTriangles;
-    for ( VertexType *v : NearVertices ) {
+    SpatialQueryBuffer Buffer;
+    this->GetTrianglesAround(c, r, NearTriangles, Buffer);
+    return NearTriangles;
+}
+
+void MeshData :: GetTrianglesAround(std :: array< double, 3 >c, double r, std :: vector< TriangleType * > &Result, SpatialQueryBuffer &Buffer) const
+{
+    // A triangle may have several vertices within the sphere, thus the vertices need not be unique but the triangles do
+    this->VertexGrid->GiveVerticesWithinSphere(c [ 0 ], c [ 1 ], c [ 2 ], r, Buffer.Vertices);
+    Result.clear();
+    for ( VertexType *v : Buffer.Vertices ) {
+        Result.insert( Result.end(), v->Triangles.begin(), v->Triangles.end() );
+    }
+    std :: sort( Result.begin(), Result.end() );
+    Result.erase( std :: unique( Result.begin(), Result.end() ), Result.end() );
+}
+
+void MeshData :: UpdateVertexPositions(std :: vector< VertexType * > &MovedVertices)
+{
+    if ( MovedVertices.size() > this->Vertices.size() / 4 ) {
+        this->VertexGrid->Rebuild();
+        if ( this->TriangleTreeBuilt ) {
+            this->TriangleTree.RefitAll();
+        }
+        return;
+    }
+
+    for ( VertexType *v : MovedVertices ) {
+        this->VertexGrid->MoveVertex(v->ID);
+        this->RefitTriangleTree(v);
+    }
+}
+
+void MeshData :: UpdateTriangleTree()
+{
+    if ( this->TriangleTreeBuilt ) {
+        this->TriangleTree.RefitAll();
+    } else {
+        this->TriangleTree.Build(this->Triangles);
+        this->TriangleTreeBuilt = true;
+    }
+}
+
+void MeshData :: RefitTriangleTree(VertexType *v)
+{
+    if ( this->TriangleTreeBuilt ) {
         for ( TriangleType *t : v->Triangles ) {
-            NearTriangles.push_back(t);
+            this->TriangleTree.Refit(t);
         }
     }
-    std :: sort( NearTriangles.begin(), NearTriangles.end() );
-    NearTriangles.erase( std :: unique( NearTriangles.begin(), NearTriangles.end() ), NearTriangles.end() );
+}
+
+void MeshData :: BuildTriangleTree()
+{
+    if ( !this->TriangleTreeBuilt ) {
+        this->UpdateTriangleTree();
+    }
+}
 
+std :: vector< TriangleType * >MeshData :: GetTrianglesNear(TriangleType *t)
+{
+    this->BuildTriangleTree();
+
+    std :: vector< TriangleType * >NearTriangles;
+    SpatialQueryBuffer Buffer;
+    this->GetTrianglesNear(t, NearTriangles, Buffer);
     return NearTriangles;
 }
 
+void MeshData :: GetTrianglesNear(TriangleType *t, std :: vector< TriangleType * > &Result, SpatialQueryBuffer &Buffer) const
+{
+    if ( !this->TriangleTreeBuilt ) {
+        STATUS("Tree of triangle bounding boxes not built\n", 0);
+        throw( 0 );
+    }
+
+    std :: array< double, 3 >min, max;
+    for ( int i = 0; i < 3; i++ ) {
+        min [ i ] = max [ i ] = t->Vertices [ 0 ]->get_c(i);
+        for ( int j = 1; j < 3; j++ ) {
+            min [ i ] = std :: min( min [ i ], t->Vertices [ j ]->get_c(i) );
+            max [ i ] = std :: max( max [ i ], t->Vertices [ j ]->get_c(i) );
+        }
+        min [ i ] = min [ i ] - EPS;
+        max [ i ] = max [ i ] + EPS;
+    }
+
+    Result.clear();
+    this->TriangleTree.Query(min, max, Result, Buffer.Stack);
+}
+
+void MeshData :: FindIntersectingTriangles(std :: vector< VertexType * > &MovedVertices, std :: vector< std :: pair< TriangleType *, TriangleType * > > &IntersectingTriangles,
+                                           SpatialQueryBuffer &Buffer)
+{
+    IntersectingTriangles.clear();
+
+    this->UpdateVertexPositions(MovedVertices);
+    this->BuildTriangleTree();
+
+    // Triangles of moved vertices. All other pairs of triangles are as in the last check.
+    std :: vector< TriangleType * >MovedTriangles;
+    for ( VertexType *v : MovedVertices ) {
+        for ( TriangleType *t : v->Triangles ) {
+            MovedTriangles.push_back(t);
+        }
+    }
+    std :: sort( MovedTriangles.begin(), MovedTriangles.end() );
+    MovedTriangles.erase( std :: unique( MovedTriangles.begin(), MovedTriangles.end() ), MovedTriangles.end() );
+
+    for ( TriangleType *t1 : MovedTriangles ) {
+        this->GetTrianglesNear(t1, Buffer.Triangles, Buffer);
+
+        for ( TriangleType *t2 : Buffer.Triangles ) {
+            // Pairs of moved triangles are tested once
+            if ( ( t1 == t2 ) || ( ( t2 < t1 ) && std :: binary_search(MovedTriangles.begin(), MovedTriangles.end(), t2) ) ) {
+                continue;
+            }
+            if ( this->CheckTrianglePenetration(t1, t2) ) {
+                IntersectingTriangles.push_back({ t1, t2 });
+                LOG("Triangles %u and %u intersect!\n", t1->ID, t2->ID);
+            }
+        }
+    }
+}
+
+FC_MESH MeshData :: CheckTrianglePenetrationNear(TriangleType *t, const std :: vector< TriangleType * > &Ignore, SpatialQueryBuffer &Buffer)
+{
+    this->BuildTriangleTree();
+    this->GetTrianglesNear(t, Buffer.Triangles, Buffer);
+
+    for ( TriangleType *t2 : Buffer.Triangles ) {
+        if ( std :: find(Ignore.begin(), Ignore.end(), t2) != Ignore.end() ) {
+            continue;
+        }
+        FC_MESH R = this->CheckTrianglePenetration(t, t2);
+        if ( R != FC_OK ) {
+            return R;
+        }
+    }
+    return FC_OK;
+}
+
 bool MeshData :: CheckSameOrientation(TriangleType *t1, TriangleType *t2)
 {
     for ( int i = 0; i < 3; i++ ) {
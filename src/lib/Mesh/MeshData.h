@@ -4,11 +4,16 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "MeshComponents.h"
-#include "VertexOctreeNode.h"
+#include "VertexHashGrid.h"
 #include "VTKExporter.h"
 #include "SimpleExporter.h"
+#include "MeshSnapshot.h"
+#include "TriangleAABBTree.h"
 #include "TriTriIntersect.h"
 
 namespace voxel2tet
@@ -22,8 +27,25 @@ enum FC_MESH {
 };
 
 
+/**
+ * @brief Scratch storage for the spatial queries in MeshData. Reusing the same buffer between queries avoids allocating
+ * memory for each query. Threads running queries concurrently must use one buffer each.
+ */
+struct SpatialQueryBuffer {
+    std :: vector< VertexType * >Vertices;
+    std :: vector< int >Stack;
+    std :: vector< TriangleType * >Triangles;
+};
+
 /**
  * @brief The MeshData class supplies information and methods for handling mesh data.
+ *
+ * Concurrency: The const spatial queries (GetTrianglesAround and GetTrianglesNear taking a SpatialQueryBuffer) may be
+ * called from several threads at the same time, given that each thread uses its own result list and buffer, and that no
+ * thread changes the mesh in the meanwhile. Changing the mesh includes moving vertices, adding or removing triangles,
+ * and updating the spatial structures, e.g. by UpdateVertexPositions or UpdateTriangleTree. The tree of triangle bounding
+ * boxes must be built, e.g. by BuildTriangleTree, before any concurrent query. All other member functions require
+ * exclusive access.
  */
 class MeshData
 {
@@ -31,13 +53,41 @@ private:
     int TriangleCounter;
     int EdgeCounter;
 
+    /**
+     * @brief Computes the Morton (Z-order) code of a coordinate relative to the bounding box of the mesh
+     * @param c Coordinate
+     * @return Interleaved 63 bit code, 21 bits per direction
+     */
+    uint64_t GiveMortonCode(std :: array< double, 3 >c);
+
+    // Bounding volume hierarchy over Triangles. Once built, it is kept up to date by AddTriangle and RemoveTriangle.
+    TriangleAABBTree TriangleTree;
+    bool TriangleTreeBuilt;
+
 public:
 
     /**
      * @brief Perform sanity check. Mostly for debugging purposes to make sure that the connectivity of the mesh is kept in order.
+     * Throws an exception if ValidateMesh fails.
      */
     void DoSanityCheck();
 
+    /**
+     * @brief Validates the mesh in linear time using hash sets of canonical edge and triangle keys.
+     *
+     * The following is checked:
+     *  - No degenerate or duplicate edges and triangles
+     *  - Incidence symmetry, i.e. each vertex knows about all edges and triangles it is part of and vice versa
+     *  - All edges of each triangle are present in Edges
+     *  - Manifoldness per interface. An edge shared by more than two triangles on the same interface is reported as a warning.
+     *  - Consistent orientation of neighbouring triangles on the same interface
+     *
+     * Problems are reported using STATUS.
+     *
+     * @return True if no errors were found, false otherwise
+     */
+    bool ValidateMesh();
+
     /**
      * @brief Bounding box of mesh
      */
@@ -64,9 +114,9 @@ public:
     std :: vector< TetType * >Tets;
 
     /**
-     * @brief VertexOctreeNode root object for all vertices. Uses octree algorithm for performance.
+     * @brief Spatial hash of all vertices. Used for finding and merging vertices by coordinate.
      */
-    VertexOctreeNode *VertexOctreeRoot;
+    VertexHashGrid *VertexGrid;
 
     /**
      * @brief Constructor
@@ -76,6 +126,22 @@ public:
 
     ~MeshData();
 
+    /**
+     * @brief Sorts Vertices and Triangles along a Morton (Z-order) space filling curve and renumbers them.
+     *
+     * Vertices and triangles are otherwise ordered by creation, which interleaves interfaces across the
+     * domain. After sorting, vertices close in space are close in the lists which improves cache behaviour
+     * for the following stages. The ID of each vertex is set to its new index, the vertex grid is updated
+     * accordingly and the triangles are given consecutive IDs. Pointers are not affected.
+     */
+    void ReorderMesh();
+
+    /**
+     * @brief Creates a flat, read-only copy of the current mesh. The caller owns the returned object.
+     * @return Pointer to new MeshSnapshot object
+     */
+    MeshSnapshot *CreateSnapshot();
+
     /**
      * @brief Exports all Surface objects to file of preferred format
      * @param FileName Name of file
@@ -83,6 +149,14 @@ public:
      */
     void ExportSurface(std :: string FileName, Exporter_FileTypes FileType);
 
+    /**
+     * @brief Exports a snapshot of the surfaces to file of preferred format. Use this to write several files from the same
+     * state of the mesh without copying it again.
+     * @param FileName Name of file
+     * @param FileType Type of file
+     * @param Snapshot Snapshot of mesh, see CreateSnapshot
+     */
+    void ExportSurface(std :: string FileName, Exporter_FileTypes FileType, MeshSnapshot *Snapshot);
 
     /**
      * @brief Exports all Volume objects to a file of preferred format
@@ -91,6 +165,14 @@ public:
      */
     void ExportVolume(std :: string FileName, Exporter_FileTypes FileType);
 
+    /**
+     * @brief Exports a snapshot of the volumes to file of preferred format
+     * @param FileName Name of file
+     * @param FileType Type of file
+     * @param Snapshot Snapshot of mesh, see CreateSnapshot
+     */
+    void ExportVolume(std :: string FileName, Exporter_FileTypes FileType, MeshSnapshot *Snapshot);
+
     /**
      * @brief Adds an Edge object to Edges given vertex IDs
      *
@@ -176,6 +258,80 @@ public:
      */
     std :: vector< TriangleType * >GetTrianglesAround(std :: array< double, 3 >c, double r);
 
+    /**
+     * @brief Gives all triangles with at least one vertex within a sphere. Thread safe, see the class description.
+     * @param c [in] Center of sphere
+     * @param r [in] Radius of sphere
+     * @param Result [out] List of triangles. Any previous content is removed.
+     * @param Buffer [in, out] Scratch storage
+     */
+    void GetTrianglesAround(std :: array< double, 3 >c, double r, std :: vector< TriangleType * > &Result, SpatialQueryBuffer &Buffer) const;
+
+    /**
+     * @brief Updates VertexGrid, and the tree of triangle bounding boxes if built, after vertices have been moved. If a
+     * large part of the mesh has moved, both structures are rebuilt, otherwise each vertex is updated individually.
+     * @param MovedVertices List of vertices that have been moved
+     */
+    void UpdateVertexPositions(std :: vector< VertexType * > &MovedVertices);
+
+    /**
+     * @brief Builds the tree of triangle bounding boxes if not yet built, otherwise updates all boxes.
+     *
+     * The tree follows topology changes made through AddTriangle and RemoveTriangle, but not vertex movements. Call this
+     * after vertices have been moved, e.g. after smoothing, or use RefitTriangleTree or UpdateVertexPositions.
+     */
+    void UpdateTriangleTree();
+
+    /**
+     * @brief Builds the tree of triangle bounding boxes if not yet built. Nothing happens otherwise.
+     */
+    void BuildTriangleTree();
+
+    /**
+     * @brief Updates the boxes of all triangles connected to a vertex after it has been moved
+     * @param v Pointer to vertex
+     */
+    void RefitTriangleTree(VertexType *v);
+
+    /**
+     * @brief Gives all triangles in the mesh whose bounding boxes overlap the bounding box of a triangle. The triangle
+     * need not be part of the mesh.
+     * @param t [in] Pointer to triangle
+     * @return List of triangles
+     */
+    std :: vector< TriangleType * >GetTrianglesNear(TriangleType *t);
+
+    /**
+     * @brief Gives all triangles in the mesh whose bounding boxes overlap the bounding box of a triangle. Thread safe,
+     * see the class description. Throws an exception if the tree of triangle bounding boxes is not built.
+     * @param t [in] Pointer to triangle
+     * @param Result [out] List of triangles. Any previous content is removed.
+     * @param Buffer [in, out] Scratch storage
+     */
+    void GetTrianglesNear(TriangleType *t, std :: vector< TriangleType * > &Result, SpatialQueryBuffer &Buffer) const;
+
+    /**
+     * @brief Finds all pairs of intersecting triangles where at least one of the triangles is connected to a moved vertex.
+     * The spatial structures are updated for the moved vertices, then each triangle of the moved vertices is tested against
+     * the triangles with overlapping bounding boxes. The cost thus depends on the number of moved vertices and not on the
+     * size of the mesh.
+     * @param MovedVertices [in] Vertices moved since the last check
+     * @param IntersectingTriangles [out] Pairs of intersecting triangles, each pair once. Any previous content is removed.
+     * @param Buffer [in, out] Scratch storage
+     */
+    void FindIntersectingTriangles(std :: vector< VertexType * > &MovedVertices, std :: vector< std :: pair< TriangleType *, TriangleType * > > &IntersectingTriangles,
+                                   SpatialQueryBuffer &Buffer);
+
+    /**
+     * @brief Checks if a triangle, not necessarily part of the mesh, penetrates any triangle in the mesh with overlapping
+     * bounding box.
+     * @param t [in] Pointer to triangle
+     * @param Ignore [in] Triangles not to check against, e.g. triangles to be replaced by t
+     * @param Buffer [in, out] Scratch storage
+     * @return FC_OK if no triangle is penetrated, otherwise the status of the first penetrated triangle
+     */
+    FC_MESH CheckTrianglePenetrationNear(TriangleType *t, const std :: vector< TriangleType * > &Ignore, SpatialQueryBuffer &Buffer);
+
     /**
      * @brief CheckSameOrientation tells if two neighbouring triangles are oriented in the same
      * way by comparing the order of the vertices on the shared edge
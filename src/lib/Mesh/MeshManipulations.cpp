@@ -248,25 +248,12 @@ FC_MESH MeshManipulations :: FlipEdge(EdgeType *Edge)
         }
     }
 
-    // Check if any of the new triangles penetrates any of the old triangles nearby
-
-    // Add all triangles nearby to NearTriangles
-    std :: array< double, 3 >cm = NewEdge.GiveCenterPoint();
-    std :: vector< TriangleType * >NearTriangles = this->GetTrianglesAround(cm, this->LongestEdgeLength);
-
-    // Remove EdgeTriangles from NearTriangles
-    for ( int i = 0; i < 2; i++ ) {
-        NearTriangles.erase( std :: remove(NearTriangles.begin(), NearTriangles.end(), EdgeTriangles [ i ]), NearTriangles.end() );
-    }
-
     // Check if new triangles penetrates existing triangles (except those that will be deleted of course)
     for ( TriangleType *t1 : NewTriangles ) {
-        for ( TriangleType *t2 : NearTriangles ) {
-            FC_MESH R = this->CheckTrianglePenetration(t1, t2);
-            if ( R != FC_OK ) {
-                LOG("Unable to flip edge. Will result in penetration\n", 0);
-                return R;
-            }
+        FC_MESH R = this->CheckTrianglePenetrationNear(t1, EdgeTriangles, this->QueryBuffer);
+        if ( R != FC_OK ) {
+            LOG("Unable to flip edge. Will result in penetration\n", 0);
+            return R;
         }
     }
 
@@ -398,21 +385,22 @@ FC_MESH MeshManipulations :: CollapseEdgeTest(std :: vector< TriangleType * > *T
 
     LOG("Check if new triangles intersect...\n", 0);
 
-    // Collect all point close to the centerpoint of the edge to collapse. The, form a list of all triangles connected to those points and perform check on all triangles in that list (except with triangles to remove).
-    std :: array< double, 3 >cp = EdgeToCollapse->GiveCenterPoint();
-    std :: vector< TriangleType * >TrianglesNear;
-    TrianglesNear = this->GetTrianglesAround(cp, this->LongestEdgeLength);
-
-    for ( TriangleType *t : TrianglesNear ) {
-        // Skip triangles that will be removed
-        bool DoCheck = true;
-        for ( TriangleType *remt : *TrianglesToRemove ) {
-            if ( remt == t ) {
-                DoCheck = false;
+    // Check each new triangle against the triangles with overlapping bounding boxes. The triangles to save are moved to
+    // the positions of the new triangles, thus their boxes in the tree are outdated and they are always included.
+    this->BuildTriangleTree();
+    for ( TriangleType *newt : *NewTriangles ) {
+        this->GetTrianglesNear(newt, this->QueryResult, this->QueryBuffer);
+        std :: vector< TriangleType * > &TrianglesNear = this->QueryResult;
+        TrianglesNear.insert( TrianglesNear.end(), TrianglesToSave->begin(), TrianglesToSave->end() );
+        std :: sort( TrianglesNear.begin(), TrianglesNear.end() );
+        TrianglesNear.erase( std :: unique( TrianglesNear.begin(), TrianglesNear.end() ), TrianglesNear.end() );
+
+        for ( TriangleType *t : TrianglesNear ) {
+            // Skip triangles that will be removed
+            if ( std :: find(TrianglesToRemove->begin(), TrianglesToRemove->end(), t) != TrianglesToRemove->end() ) {
+                continue;
             }
-        }
 
-        if ( DoCheck ) {
             // For this test we need to change RemoveVertex --> SaveVertex
             std :: array< VertexType *, 3 >NearTriVertices = t->Vertices;
             for ( int i = 0; i < 3; i++ ) {
@@ -422,26 +410,21 @@ FC_MESH MeshManipulations :: CollapseEdgeTest(std :: vector< TriangleType * > *T
                 }
             }
 
-            for ( TriangleType *newt : *NewTriangles ) {
-                std :: array< VertexType *, 3 >t1 = {
-                    NearTriVertices [ 0 ], NearTriVertices [ 1 ], NearTriVertices [ 2 ]
-                };
-                std :: array< VertexType *, 3 >t2 = {
-                    newt->Vertices [ 0 ], newt->Vertices [ 1 ], newt->Vertices [ 2 ]
-                };
+            std :: array< VertexType *, 3 >t2 = {
+                newt->Vertices [ 0 ], newt->Vertices [ 1 ], newt->Vertices [ 2 ]
+            };
 
-                int sv;
-                FC_MESH nf = CheckTrianglePenetration(t1, t2, sv);
+            int sv;
+            FC_MESH nf = CheckTrianglePenetration(NearTriVertices, t2, sv);
 
-                if ( nf == FC_DUPLICATETRIANGLE ) {
-                    if ( newt->ID == -t->ID ) {
-                        nf = FC_OK;
-                    }
+            if ( nf == FC_DUPLICATETRIANGLE ) {
+                if ( newt->ID == -t->ID ) {
+                    nf = FC_OK;
                 }
+            }
 
-                if ( nf != FC_OK ) {
-                    return nf;
-                }
+            if ( nf != FC_OK ) {
+                return nf;
             }
         }
     }
@@ -475,6 +458,7 @@ FC_MESH MeshManipulations :: CollapseEdge(EdgeType *EdgeToCollapse, int RemoveVe
     }
 
     VertexType *SaveVertex = EdgeToCollapse->Vertices [ SaveVertexIndex ];
+    VertexType *RemoveVertex = EdgeToCollapse->Vertices [ RemoveVertexIndex ];
 
     // Create new triangles. These are create by moving RemoveVertex to the other end of the edge and remove the 0-area triangles
     std :: vector< TriangleType * >TrianglesToRemove = EdgeToCollapse->GiveTriangles();
@@ -610,6 +594,9 @@ FC_MESH MeshManipulations :: CollapseEdge(EdgeType *EdgeToCollapse, int RemoveVe
         this->AddTriangle(t);
     }
 
+    // RemoveVertex is no longer part of the mesh
+    this->VertexGrid->RemoveVertex(RemoveVertex->ID);
+
     // DoSanityCheck();
 
     ConnectedEdges = SaveVertex->Edges;
@@ -876,7 +863,8 @@ std :: vector< VertexType * >MeshManipulations :: FindIndependentSet()
 
 int MeshManipulations :: FlipAll()
 {
-    this->UpdateLongestEdgeLength();
+    // Vertices may have moved since the last call
+    this->UpdateTriangleTree();
 
     int flipcount = 0;
     int i = 0;
@@ -898,19 +886,157 @@ int MeshManipulations :: FlipAll()
     }
     return flipcount;
 }
-void MeshManipulations :: UpdateLongestEdgeLength()
+
+int MeshManipulations :: SimplifyPhaseEdges(std :: vector< PhaseEdge * > &PhaseEdges, double MaxDistance)
 {
-    this->LongestEdgeLength=0;
-    for (EdgeType *e: this->Edges) {
-        double ThisLength = e->GiveLength();
-        this->LongestEdgeLength = std::max(ThisLength, this->LongestEdgeLength);
+    STATUS("Simplify phase edges\n", 0);
+
+    // Vertices may have moved since the last call
+    this->UpdateTriangleTree();
+
+    // Index of the vertex where the span Chain[Start]...Chain[End] is split, or 0 if the span can be replaced by one segment
+    auto GiveSplitIndex = [ this, MaxDistance ](std :: vector< VertexType * > &Chain, size_t Start, size_t End) -> size_t {
+        std :: array< double, 3 >a = Chain [ Start ]->get_c();
+        std :: array< double, 3 >Chord;
+        double ChordLength2 = 0.0;
+        for ( int j = 0; j < 3; j++ ) {
+            Chord [ j ] = Chain [ End ]->get_c(j) - a [ j ];
+            ChordLength2 += Chord [ j ] * Chord [ j ];
+        }
+
+        // A closed edge with only one vertex kept gives a span from a vertex to itself, which always has to be split
+        bool Split = ( Chain [ Start ] == Chain [ End ] ) || ( ChordLength2 == 0.0 );
+
+        size_t MaxIndex = ( Start + End ) / 2;
+        double MaxDistance2 = 0.0;
+        for ( size_t k = Start + 1; k < End; k++ ) {
+            std :: array< double, 3 >p;
+            double t = 0.0;
+            for ( int j = 0; j < 3; j++ ) {
+                p [ j ] = Chain [ k ]->get_c(j) - a [ j ];
+                t += p [ j ] * Chord [ j ];
+            }
+            t = Split ? 0.0 : std :: min( std :: max(t / ChordLength2, 0.0), 1.0 );
+
+            double Distance2 = 0.0;
+            for ( int j = 0; j < 3; j++ ) {
+                Distance2 += ( p [ j ] - t * Chord [ j ] ) * ( p [ j ] - t * Chord [ j ] );
+            }
+            if ( Distance2 > MaxDistance2 ) {
+                MaxDistance2 = Distance2;
+                MaxIndex = k;
+            }
+        }
+
+        if ( MaxDistance2 > MaxDistance * MaxDistance ) {
+            Split = true;
+        }
+
+        // Compare the direction of each segment with the direction of the chord
+        for ( size_t k = Start; ( k < End ) && !Split; k++ ) {
+            std :: array< double, 3 >Direction = ComputeNormalizedVector(Chain [ k ], Chain [ k + 1 ]);
+            double CosAlpha = 0.0;
+            for ( int j = 0; j < 3; j++ ) {
+                CosAlpha += Direction [ j ] * Chord [ j ];
+            }
+            CosAlpha = std :: min( std :: max(CosAlpha / std :: sqrt(ChordLength2), -1.0), 1.0 );
+            if ( std :: acos(CosAlpha) > TOL_COL_CHORD_MAXNORMALCHANGE ) {
+                Split = true;
+            }
+        }
+
+        return Split ? MaxIndex : 0;
+    };
+
+    int RemovedCount = 0;
+
+    for ( PhaseEdge *pe : PhaseEdges ) {
+        // Vertices in the order they appear on the phase edge. For closed edges, the first vertex is repeated at the end.
+        std :: vector< VertexType * >Chain = pe->GetFlatListOfVertices();
+        if ( Chain.size() != pe->EdgeSegments.size() + 1 ) {
+            LOG("Phase edge @%p is not one connected curve and is not simplified\n", pe);
+            continue;
+        }
+
+        std :: vector< bool >Keep( Chain.size(), false );
+        Keep.front() = true;
+        Keep.back() = true;
+        for ( size_t i = 0; i < Chain.size(); i++ ) {
+            if ( Chain [ i ]->IsFixedVertex() ) {
+                Keep [ i ] = true;
+            }
+        }
+
+        // Douglas-Peucker on each span between kept vertices
+        std :: vector< std :: pair< size_t, size_t > >Spans;
+        size_t Start = 0;
+        for ( size_t i = 1; i < Chain.size(); i++ ) {
+            if ( Keep [ i ] ) {
+                Spans.push_back({ Start, i });
+                Start = i;
+            }
+        }
+
+        while ( !Spans.empty() ) {
+            std :: pair< size_t, size_t >Span = Spans.back();
+            Spans.pop_back();
+            if ( Span.second - Span.first < 2 ) {
+                continue;
+            }
+
+            size_t SplitIndex = GiveSplitIndex(Chain, Span.first, Span.second);
+            if ( SplitIndex != 0 ) {
+                Keep [ SplitIndex ] = true;
+                Spans.push_back({ Span.first, SplitIndex });
+                Spans.push_back({ SplitIndex, Span.second });
+            }
+        }
+
+        // Collapse each removed vertex into the previous kept vertex. If the collapse is not permitted, the vertex is kept.
+        size_t SaveIndex = 0;
+        for ( size_t i = 1; i < Chain.size(); i++ ) {
+            if ( !Keep [ i ] ) {
+                VertexType *RemoveVertex = Chain [ i ];
+                EdgeType *EdgeToCollapse = NULL;
+                for ( EdgeType *e : Chain [ SaveIndex ]->Edges ) {
+                    if ( ( e->Vertices [ 0 ] == RemoveVertex ) || ( e->Vertices [ 1 ] == RemoveVertex ) ) {
+                        EdgeToCollapse = e;
+                        break;
+                    }
+                }
+
+                if ( EdgeToCollapse != NULL ) {
+                    int RemoveVertexIndex = ( EdgeToCollapse->Vertices [ 0 ] == RemoveVertex ) ? 0 : 1;
+                    if ( this->CollapseEdge(EdgeToCollapse, RemoveVertexIndex) == FC_OK ) {
+                        pe->RemoveVertex(RemoveVertex);
+                        RemovedCount++;
+                        continue;
+                    }
+                }
+            }
+            SaveIndex = i;
+        }
     }
+
+    STATUS("Removed %u vertices from phase edges\n", RemovedCount);
+
+#if SANITYCHECK == 1
+    if ( !this->ValidateMesh() ) {
+        STATUS("Invalid mesh after simplifying phase edges\n", 0);
+        throw 0;
+    }
+#endif
+
+    return RemovedCount;
 }
 
 void MeshManipulations :: CoarsenMesh()
 {
     STATUS("Coarsen mesh\n", 0);
 
+    // Vertices may have moved since the last call
+    this->UpdateTriangleTree();
+
     bool CoarseningOccurs = true;
     int iter = 0;
 
@@ -953,7 +1079,6 @@ void MeshManipulations :: CoarsenMesh()
                 // If vertex v is not in the set of independent vertices, try to collapse
                 if ( std :: find(IndepSet.begin(), IndepSet.end(), v) == IndepSet.end() ) {
                     if ( this->CollapseEdge(e, vi) == FC_OK ) {
-                        this->UpdateLongestEdgeLength();
                         CoarseningOccurs = true;
 #if EXPORT_MESH_COARSENING
                         this->ExportSurface(strfmt("/tmp/Coarseningp_%u.simple", MeshIndex), FT_SIMPLE);
@@ -974,16 +1099,9 @@ void MeshManipulations :: CoarsenMesh()
 
 
 #if SANITYCHECK == 1
-        for ( TriangleType *t1 : this->Triangles ) {
-            for ( TriangleType *t2 : this->Triangles ) {
-                if ( t1 != t2 ) {
-                    bool ispermutation = std :: is_permutation( t1->Vertices.begin(), t1->Vertices.end(), t2->Vertices.begin() );
-                    if ( ispermutation ) {
-                        STATUS("\nDuplicate triangles at iteration %u, failcount %u\n", iter, failcount);
-                        throw 0;
-                    }
-                }
-            }
+        if ( !this->ValidateMesh() ) {
+            STATUS("\nInvalid mesh at iteration %u\n", iter);
+            throw 0;
         }
 #endif
     }
@@ -25,9 +25,6 @@ class MeshManipulations : public MeshData
 {
 private:
 
-    double LongestEdgeLength;
-    void UpdateLongestEdgeLength();
-
     /**
      * @brief GetFlippedEdgeData Produce new edge and new triangles for a flipped edge
      * @param EdgeToFlip Vector to flip
@@ -40,6 +37,10 @@ private:
     void SortEdgesByLength();
     void SortEdgesByMinArea();
 
+    // Scratch storage for the spatial queries in FlipEdge and CollapseEdgeTest
+    SpatialQueryBuffer QueryBuffer;
+    std :: vector< TriangleType * >QueryResult;
+
 public:
 
     /**
@@ -164,6 +165,18 @@ public:
      */
     FC_MESH CheckCoarsenChord(EdgeType *EdgeToCollapse, VertexType *RemoveVertex, VertexType *SaveVertex);
 
+    /**
+     * @brief Simplifies each phase edge as a polyline before the surface is coarsened. The vertices to keep are found by
+     * the Douglas-Peucker algorithm, where a span of the polyline is replaced by one segment if no vertex is further than
+     * MaxDistance from the segment and no direction of the polyline deviates more than TOL_COL_CHORD_MAXNORMALCHANGE
+     * from it. Vertices where phase edges meet are always kept. The other vertices are removed by collapsing the edge
+     * to the previous vertex on the phase edge, i.e. only collapses passing all tests in CollapseEdge are performed.
+     * @param PhaseEdges Phase edges to simplify
+     * @param MaxDistance Largest distance from a removed vertex to the simplified polyline
+     * @return Number of removed vertices
+     */
+    int SimplifyPhaseEdges(std :: vector< PhaseEdge * > &PhaseEdges, double MaxDistance);
+
     /**
      * @brief Coarsen surface mesh
      */
@@ -0,0 +1,102 @@
+#include <unordered_map>
+
+#include "MeshSnapshot.h"
+#include "MiscFunctions.h"
+
+namespace voxel2tet
+{
+// Creates a compact numbering of the vertices referenced in Connectivity
+static void CompactVertices(std :: vector< int > &Connectivity, size_t NumberOfVertices, std :: vector< int > &UsedVertices, std :: vector< int > &VertexIndex)
+{
+    VertexIndex.assign(NumberOfVertices, -1);
+    for ( int v : Connectivity ) {
+        VertexIndex [ v ] = 0;
+    }
+
+    UsedVertices.clear();
+    for ( size_t i = 0; i < NumberOfVertices; i++ ) {
+        if ( VertexIndex [ i ] == 0 ) {
+            VertexIndex [ i ] = UsedVertices.size();
+            UsedVertices.push_back(i);
+        }
+    }
+}
+
+MeshSnapshot :: MeshSnapshot(std :: vector< TriangleType * > *Triangles, std :: vector< VertexType * > *Vertices, std :: vector< EdgeType * > *Edges, std :: vector< TetType * > *Tets)
+{
+    LOG("Create snapshot of %zu vertices, %zu triangles and %zu tetrahedrons\n", Vertices->size(), Triangles->size(), Tets->size());
+
+    // Vertices. MeshData keeps the ID of each vertex equal to its index in the list, thus the ID can be used directly.
+    // If that is not the case, fall back to a hash map.
+    bool IDIsIndex = true;
+    Coordinates.reserve(Vertices->size() * 3);
+    VertexIDs.reserve( Vertices->size() );
+    VertexTags.reserve( Vertices->size() );
+    VertexErrors.reserve( Vertices->size() );
+    for ( size_t i = 0; i < Vertices->size(); i++ ) {
+        VertexType *v = Vertices->at(i);
+        for ( int j = 0; j < 3; j++ ) {
+            Coordinates.push_back( v->get_c(j) );
+        }
+        VertexIDs.push_back(v->ID);
+        VertexTags.push_back(v->tag);
+        VertexErrors.push_back(v->error);
+        if ( v->ID != int( i ) ) {
+            IDIsIndex = false;
+        }
+    }
+
+    std :: unordered_map< VertexType *, int >VertexIndices;
+    if ( !IDIsIndex ) {
+        VertexIndices.reserve( Vertices->size() );
+        for ( size_t i = 0; i < Vertices->size(); i++ ) {
+            VertexIndices [ Vertices->at(i) ] = i;
+        }
+    }
+
+    auto GiveIndex = [ & ](VertexType * v) {
+                         return IDIsIndex ? v->ID : VertexIndices.at(v);
+                     };
+
+    // Edges
+    EdgeVertices.reserve(Edges->size() * 2);
+    EdgeIDs.reserve( Edges->size() );
+    for ( EdgeType *e : *Edges ) {
+        for ( VertexType *v : e->Vertices ) {
+            EdgeVertices.push_back( GiveIndex(v) );
+        }
+        EdgeIDs.push_back(e->ID);
+    }
+
+    // Triangles
+    TriangleVertices.reserve(Triangles->size() * 3);
+    TriangleIDs.reserve( Triangles->size() );
+    InterfaceIDs.reserve( Triangles->size() );
+    PosNormalMatIDs.reserve( Triangles->size() );
+    NegNormalMatIDs.reserve( Triangles->size() );
+    for ( TriangleType *t : *Triangles ) {
+        for ( VertexType *v : t->Vertices ) {
+            TriangleVertices.push_back( GiveIndex(v) );
+        }
+        TriangleIDs.push_back(t->ID);
+        InterfaceIDs.push_back(t->InterfaceID);
+        PosNormalMatIDs.push_back(t->PosNormalMatID);
+        NegNormalMatIDs.push_back(t->NegNormalMatID);
+    }
+
+    // Tetrahedrons
+    TetVertices.reserve(Tets->size() * 4);
+    TetIDs.reserve( Tets->size() );
+    TetMaterialIDs.reserve( Tets->size() );
+    for ( TetType *t : *Tets ) {
+        for ( VertexType *v : t->Vertices ) {
+            TetVertices.push_back( GiveIndex(v) );
+        }
+        TetIDs.push_back(t->ID);
+        TetMaterialIDs.push_back(t->MaterialID);
+    }
+
+    CompactVertices(TriangleVertices, Vertices->size(), SurfaceVertices, SurfaceVertexIndex);
+    CompactVertices(TetVertices, Vertices->size(), VolumeVertices, VolumeVertexIndex);
+}
+}
@@ -0,0 +1,100 @@
+#ifndef MESHSNAPSHOT_H
+#define MESHSNAPSHOT_H
+
+#include <vector>
+
+#include "MeshComponents.h"
+
+namespace voxel2tet
+{
+/**
+ * @brief The MeshSnapshot class holds a flat, read-only copy of a mesh.
+ *
+ * All vertices are numbered by their index in the list of vertices and all connectivity is stored as contiguous arrays
+ * of such indices. The snapshot is created once and can then be used by any number of consumers (exporters, TetGenCaller)
+ * without map lookups and without modifying the mesh, e.g. the tag member of the vertices is never touched. Since nothing
+ * is modified, several exports can run concurrently from the same snapshot.
+ *
+ * The snapshot is not updated as the mesh changes. Create a new snapshot after modifying the mesh.
+ */
+class MeshSnapshot
+{
+public:
+    /**
+     * @brief Constructor. Copies the mesh given by the lists.
+     * @param Triangles Pointer to a list of triangles
+     * @param Vertices Pointer to a list of vertices
+     * @param Edges Pointer to a list of edges
+     * @param Tets Pointer to a list of tetrahedrons
+     */
+    MeshSnapshot(std :: vector< TriangleType * > *Triangles, std :: vector< VertexType * > *Vertices, std :: vector< EdgeType * > *Edges, std :: vector< TetType * > *Tets);
+
+    /**
+     * @brief Coordinates of all vertices, (x, y, z) for each vertex
+     */
+    std :: vector< double >Coordinates;
+
+    /**
+     * @brief ID, tag and coarsening error of each vertex
+     */
+    std :: vector< int >VertexIDs;
+    std :: vector< int >VertexTags;
+    std :: vector< double >VertexErrors;
+
+    /**
+     * @brief Vertex indices of all edges, two for each edge, and the ID of each edge
+     */
+    std :: vector< int >EdgeVertices;
+    std :: vector< int >EdgeIDs;
+
+    /**
+     * @brief Vertex indices of all triangles, three for each triangle, and attributes of each triangle
+     */
+    std :: vector< int >TriangleVertices;
+    std :: vector< int >TriangleIDs;
+    std :: vector< int >InterfaceIDs;
+    std :: vector< int >PosNormalMatIDs;
+    std :: vector< int >NegNormalMatIDs;
+
+    /**
+     * @brief Vertex indices of all tetrahedrons, four for each tetrahedron, and attributes of each tetrahedron
+     */
+    std :: vector< int >TetVertices;
+    std :: vector< int >TetIDs;
+    std :: vector< int >TetMaterialIDs;
+
+    /**
+     * @brief Indices of the vertices used by any triangle in increasing order
+     */
+    std :: vector< int >SurfaceVertices;
+
+    /**
+     * @brief For each vertex, its position in SurfaceVertices or -1 if not used by any triangle
+     */
+    std :: vector< int >SurfaceVertexIndex;
+
+    /**
+     * @brief Indices of the vertices used by any tetrahedron in increasing order
+     */
+    std :: vector< int >VolumeVertices;
+
+    /**
+     * @brief For each vertex, its position in VolumeVertices or -1 if not used by any tetrahedron
+     */
+    std :: vector< int >VolumeVertexIndex;
+
+    size_t GiveNumberOfVertices() const { return VertexIDs.size(); }
+    size_t GiveNumberOfEdges() const { return EdgeIDs.size(); }
+    size_t GiveNumberOfTriangles() const { return TriangleIDs.size(); }
+    size_t GiveNumberOfTets() const { return TetIDs.size(); }
+
+    /**
+     * @brief Coordinate of vertex
+     * @param Index Index of vertex
+     * @param Direction 0 is X, 1 is Y and 2 is Z
+     * @return Coordinate value
+     */
+    double GiveCoordinate(int Index, int Direction) const { return Coordinates [ 3 * Index + Direction ]; }
+};
+}
+#endif // MESHSNAPSHOT_H
@@ -0,0 +1,284 @@
+#include <map>
+#include <cmath>
+
+#include "SignedDistanceSmoother.h"
+
+namespace voxel2tet
+{
+// Distance used for voxels not in the set in distance transforms
+static const double FAR = 1e20;
+
+// Squared distance transform of a sampled function f with sample spacing h in linear time (Felzenszwalb and
+// Huttenlocher), i.e. d[q] = min_p((q-p)^2*h^2+f[p]). v and z are scratch storage.
+static void DistanceTransform(const std :: vector< double > &f, std :: vector< double > &d, double h, std :: vector< int > &v, std :: vector< double > &z)
+{
+    int n = f.size();
+    v.resize(n);
+    z.resize(n + 1);
+
+    // Lower envelope of the parabolas rooted at each sample
+    int k = 0;
+    v [ 0 ] = 0;
+    z [ 0 ] = -HUGE_VAL;
+    z [ 1 ] = HUGE_VAL;
+    for ( int q = 1; q < n; q++ ) {
+        double s;
+        while ( true ) {
+            int p = v [ k ];
+            s = ( ( f [ q ] + q * q * h * h ) - ( f [ p ] + p * p * h * h ) ) / ( 2.0 * h * h * ( q - p ) );
+            if ( s <= z [ k ] ) {
+                k--;
+            } else {
+                break;
+            }
+        }
+        k++;
+        v [ k ] = q;
+        z [ k ] = s;
+        z [ k + 1 ] = HUGE_VAL;
+    }
+
+    k = 0;
+    for ( int q = 0; q < n; q++ ) {
+        while ( z [ k + 1 ] < q ) {
+            k++;
+        }
+        d [ q ] = ( q - v [ k ] ) * ( q - v [ k ] ) * h * h + f [ v [ k ] ];
+    }
+}
+
+// Convolution of f with a symmetric kernel, where Kernel[k] is the weight at distance k. The values outside f are taken
+// as the closest value in f.
+static void GaussianFilter(const std :: vector< double > &f, std :: vector< double > &g, const std :: vector< double > &Kernel)
+{
+    int n = f.size();
+    int R = Kernel.size() - 1;
+    for ( int q = 0; q < n; q++ ) {
+        double Sum = 0.0;
+        for ( int k = -R; k <= R; k++ ) {
+            int p = std :: min(std :: max(q + k, 0), n - 1);
+            Sum = Sum + Kernel [ std :: abs(k) ] * f [ p ];
+        }
+        g [ q ] = Sum;
+    }
+}
+
+// Applies Transform(Line, Result, v, z) to each line of Values along axis and replaces the line by Result. The lines are
+// transformed in parallel.
+template< typename TransformType >
+static void TransformLines(std :: vector< double > &Values, const std :: array< int, 3 > &n, int axis, TransformType Transform)
+{
+    const int stride [ 3 ] = { 1, n [ 0 ], n [ 0 ] * n [ 1 ] };
+    int a1 = ( axis + 1 ) % 3;
+    int a2 = ( axis + 2 ) % 3;
+    int lines = n [ a1 ] * n [ a2 ];
+
+#pragma omp parallel
+    {
+        std :: vector< double >Line(n [ axis ]), Result(n [ axis ]);
+        std :: vector< int >v;
+        std :: vector< double >z;
+#pragma omp for schedule(static)
+        for ( int l = 0; l < lines; l++ ) {
+            int start = ( l % n [ a1 ] ) * stride [ a1 ] + ( l / n [ a1 ] ) * stride [ a2 ];
+            for ( int q = 0; q < n [ axis ]; q++ ) {
+                Line [ q ] = Values [ start + q * stride [ axis ] ];
+            }
+            Transform(Line, Result, v, z);
+            for ( int q = 0; q < n [ axis ]; q++ ) {
+                Values [ start + q * stride [ axis ] ] = Result [ q ];
+            }
+        }
+    }
+}
+
+SignedDistanceSmoother::SignedDistanceSmoother(Importer *Imp, double sigma, int passes) : Smoother ()
+{
+    this->Imp = Imp;
+    this->sigma = sigma;
+    this->passes = passes;
+
+    this->Imp->GiveSpacing(this->spacing);
+    this->Imp->GiveOrigin(this->origin);
+    this->Imp->GiveDimensions(this->dimensions);
+}
+
+void SignedDistanceSmoother::PrintParameters(std :: ostream &stream) const
+{
+    stream << "\tSigned distance smoother\n";
+    stream << "\tsigma = " << this->sigma << ", passes = " << this->passes << "\n";
+}
+
+void SignedDistanceSmoother::ComputeField(int Phase1, int Phase2, const std :: array< int, 3 > &min, const std :: array< int, 3 > &max, FieldType &Field)
+{
+    Field.min = min;
+    for ( int i = 0; i < 3; i++ ) {
+        Field.n [ i ] = max [ i ] - min [ i ] + 1;
+    }
+    const std :: array< int, 3 > &n = Field.n;
+    size_t size = size_t( n [ 0 ] ) * n [ 1 ] * n [ 2 ];
+
+    std :: vector< int >Labels(size);
+#pragma omp parallel for
+    for ( int k = 0; k < n [ 2 ]; k++ ) {
+        for ( int j = 0; j < n [ 1 ]; j++ ) {
+            for ( int i = 0; i < n [ 0 ]; i++ ) {
+                Labels [ ( size_t( k ) * n [ 1 ] + j ) * n [ 0 ] + i ] = this->Imp->GiveMaterialIDByIndex(min [ 0 ] + i, min [ 1 ] + j, min [ 2 ] + k);
+            }
+        }
+    }
+
+    // Squared distances to the closest voxel center of each phase
+    auto SquaredDistance = [ & ](int Phase, std :: vector< double > &D) {
+                               D.resize(size);
+                               for ( size_t i = 0; i < size; i++ ) {
+                                   D [ i ] = ( Labels [ i ] == Phase ) ? 0.0 : FAR;
+                               }
+                               for ( int axis = 0; axis < 3; axis++ ) {
+                                   double h = this->spacing [ axis ];
+                                   TransformLines(D, n, axis, [ h ](const std :: vector< double > &Line, std :: vector< double > &Result, std :: vector< int > &v, std :: vector< double > &z) {
+                                                      DistanceTransform(Line, Result, h, v, z);
+                                                  });
+                               }
+                           };
+
+    std :: vector< double >D1, D2;
+    SquaredDistance(Phase1, D1);
+    SquaredDistance(Phase2, D2);
+
+    // The field is -h/2 and h/2 at the centers of two adjacent voxels of Phase1 and Phase2, thus zero at the face between
+    Field.Values.resize(size);
+#pragma omp parallel for
+    for ( long i = 0; i < long( size ); i++ ) {
+        Field.Values [ i ] = 0.5 * ( std :: sqrt(D1 [ i ]) - std :: sqrt(D2 [ i ]) );
+    }
+
+    // Gaussian filter, separated in each direction
+    int R = int( std :: ceil(3.0 * this->sigma) );
+    if ( R > 0 ) {
+        std :: vector< double >Kernel(R + 1);
+        double Sum = 0.0;
+        for ( int k = 0; k <= R; k++ ) {
+            Kernel [ k ] = std :: exp(-0.5 * k * k / ( this->sigma * this->sigma ));
+            Sum = Sum + ( k == 0 ? 1.0 : 2.0 ) * Kernel [ k ];
+        }
+        for ( double &w : Kernel ) {
+            w = w / Sum;
+        }
+        for ( int axis = 0; axis < 3; axis++ ) {
+            TransformLines(Field.Values, n, axis, [ & ](const std :: vector< double > &Line, std :: vector< double > &Result, std :: vector< int > &, std :: vector< double > &) {
+                               GaussianFilter(Line, Result, Kernel);
+                           });
+        }
+    }
+}
+
+double SignedDistanceSmoother::EvaluateField(const FieldType &Field, const std :: array< double, 3 > &x, std :: array< double, 3 > &Gradient) const
+{
+    // Cell of voxel centers containing x, and the local coordinates t in the cell
+    int i0 [ 3 ], i1 [ 3 ];
+    double t [ 3 ];
+    for ( int a = 0; a < 3; a++ ) {
+        double g = ( x [ a ] - this->origin [ a ] ) / this->spacing [ a ] - 0.5 - Field.min [ a ];
+        g = std :: min(std :: max(g, 0.0), double( Field.n [ a ] - 1 ));
+        i0 [ a ] = std :: min(int( std :: floor(g) ), std :: max(Field.n [ a ] - 2, 0));
+        i1 [ a ] = std :: min(i0 [ a ] + 1, Field.n [ a ] - 1);
+        t [ a ] = g - i0 [ a ];
+    }
+
+    double Value = 0.0;
+    Gradient = { { 0.0, 0.0, 0.0 } };
+    for ( int corner = 0; corner < 8; corner++ ) {
+        int b [ 3 ] = { corner & 1, ( corner >> 1 ) & 1, ( corner >> 2 ) & 1 };
+        double w [ 3 ], dw [ 3 ];
+        for ( int a = 0; a < 3; a++ ) {
+            w [ a ] = b [ a ] ? t [ a ] : 1.0 - t [ a ];
+            dw [ a ] = ( b [ a ] ? 1.0 : -1.0 ) / this->spacing [ a ];
+        }
+        double f = Field.Values [ ( size_t( b [ 2 ] ? i1 [ 2 ] : i0 [ 2 ] ) * Field.n [ 1 ] + ( b [ 1 ] ? i1 [ 1 ] : i0 [ 1 ] ) ) * Field.n [ 0 ] + ( b [ 0 ] ? i1 [ 0 ] : i0 [ 0 ] ) ];
+        Value = Value + w [ 0 ] * w [ 1 ] * w [ 2 ] * f;
+        Gradient [ 0 ] = Gradient [ 0 ] + dw [ 0 ] * w [ 1 ] * w [ 2 ] * f;
+        Gradient [ 1 ] = Gradient [ 1 ] + w [ 0 ] * dw [ 1 ] * w [ 2 ] * f;
+        Gradient [ 2 ] = Gradient [ 2 ] + w [ 0 ] * w [ 1 ] * dw [ 2 ] * f;
+    }
+    return Value;
+}
+
+void SignedDistanceSmoother::Smooth(std :: vector< VertexType * >Vertices, MeshData *Mesh)
+{
+    std :: chrono :: steady_clock :: time_point starttime = std :: chrono :: steady_clock :: now();
+
+    std :: sort( Vertices.begin(), Vertices.end() );
+    Vertices.erase( std :: unique( Vertices.begin(), Vertices.end() ), Vertices.end() );
+
+    std :: vector< std :: array< double, 3 > >OriginalPositions( Vertices.size() );
+    for ( size_t i = 0; i < Vertices.size(); i++ ) {
+        OriginalPositions [ i ] = Vertices [ i ]->get_c();
+    }
+    std :: vector< std :: array< double, 3 > >CurrentPositions = OriginalPositions;
+
+    // Group the vertices by surface. Vertices on phase edges, and on the boundary of the domain, are not moved.
+    std :: map< std :: pair< int, int >, std :: vector< int > >Surfaces;
+    for ( size_t i = 0; i < Vertices.size(); i++ ) {
+        VertexType *v = Vertices [ i ];
+        if ( v->IsPhaseEdgeVertex() | v->Triangles.empty() ) {
+            continue;
+        }
+        TriangleType *t = v->Triangles [ 0 ];
+        if ( ( t->PosNormalMatID < 0 ) | ( t->NegNormalMatID < 0 ) ) {
+            continue;
+        }
+        Surfaces [ std :: minmax(t->PosNormalMatID, t->NegNormalMatID) ].push_back(i);
+    }
+
+    // The field must be exact within the support of the filter around the surface, thus the box is padded by twice that
+    int pad = 2 * ( int( std :: ceil(3.0 * this->sigma) ) + 2 );
+
+    for ( auto &s : Surfaces ) {
+        std :: vector< int > &Indices = s.second;
+
+        std :: array< int, 3 >min, max;
+        for ( int a = 0; a < 3; a++ ) {
+            double umin = HUGE_VAL, umax = -HUGE_VAL;
+            for ( int i : Indices ) {
+                double u = ( OriginalPositions [ i ] [ a ] - this->origin [ a ] ) / this->spacing [ a ];
+                umin = std :: min(umin, u);
+                umax = std :: max(umax, u);
+            }
+            min [ a ] = std :: max(int( std :: floor(umin) ) - pad, 0);
+            max [ a ] = std :: min(int( std :: ceil(umax) ) - 1 + pad, this->dimensions [ a ] - 1);
+        }
+
+        FieldType Field;
+        this->ComputeField(s.first.first, s.first.second, min, max, Field);
+
+        // Project onto the zero level set by Newton steps along the gradient, keeping each vertex in its voxel sized box
+#pragma omp parallel for schedule(static)
+        for ( int k = 0; k < int( Indices.size() ); k++ ) {
+            int i = Indices [ k ];
+            std :: array< double, 3 >x = OriginalPositions [ i ];
+            for ( int pass = 0; pass < this->passes; pass++ ) {
+                std :: array< double, 3 >Gradient;
+                double f = this->EvaluateField(Field, x, Gradient);
+                double g2 = Gradient [ 0 ] * Gradient [ 0 ] + Gradient [ 1 ] * Gradient [ 1 ] + Gradient [ 2 ] * Gradient [ 2 ];
+                if ( g2 == 0.0 ) {
+                    break;
+                }
+                for ( int a = 0; a < 3; a++ ) {
+                    if ( !Vertices [ i ]->Fixed [ a ] ) {
+                        x [ a ] = x [ a ] - f * Gradient [ a ] / g2;
+                        x [ a ] = std :: min(std :: max(x [ a ], OriginalPositions [ i ] [ a ] - 0.5 * this->spacing [ a ]), OriginalPositions [ i ] [ a ] + 0.5 * this->spacing [ a ]);
+                    }
+                }
+            }
+            CurrentPositions [ i ] = x;
+        }
+    }
+
+    this->UpdateAndRepair(Vertices, CurrentPositions, OriginalPositions, Mesh);
+
+    double time = std :: chrono :: duration< double >(std :: chrono :: steady_clock :: now() - starttime).count();
+    this->AddStatistics(Vertices, OriginalPositions, this->passes, time);
+}
+
+}
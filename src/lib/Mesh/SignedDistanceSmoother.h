@@ -0,0 +1,82 @@
+#ifndef SIGNEDDISTANCESMOOTHER_H
+#define SIGNEDDISTANCESMOOTHER_H
+
+#include <vector>
+#include <array>
+#include <chrono>
+
+#include "MeshComponents.h"
+#include "MeshData.h"
+#include "Importer.h"
+#include "Smoother.h"
+
+namespace voxel2tet
+{
+
+/**
+ * @brief Smooths surfaces by projecting the vertices onto the zero level set of a smoothed distance field.
+ *
+ * For each surface, separating phases a and b, the field f = (d_a - d_b)/2 is computed on the voxel centers around the
+ * surface, where d_a and d_b are the Euclidean distances to the closest voxel of phase a and b, respectively. The zero
+ * level set of f is the voxel surface. The field is smoothed by a Gaussian filter, whereby its zero level set becomes a
+ * smooth surface, and each vertex is projected onto it by a few Newton steps. Each vertex is kept within the voxel sized
+ * box centered at its original position.
+ *
+ * The cost is bounded and does not depend on how slowly an iterative smoother would converge. The voxel data must be
+ * available when smoothing, and surfaces on the boundary of the domain are not moved. Only surfaces can be smoothed by
+ * this method, not phase edges.
+ */
+class SignedDistanceSmoother : public Smoother
+{
+private:
+    Importer *Imp;
+    double sigma;
+    int passes;
+
+    double spacing [ 3 ];
+    double origin [ 3 ];
+    int dimensions [ 3 ];
+
+    // Values of a field on the voxel centers of a box of voxels. The value at voxel (min+i) is Values[(i[2]*n[1]+i[1])*n[0]+i[0]].
+    struct FieldType {
+        std :: array< int, 3 >min;
+        std :: array< int, 3 >n;
+        std :: vector< double >Values;
+    };
+
+    /**
+     * @brief Computes the smoothed distance field of the surface between two phases
+     * @param Phase1 Phase with negative field values
+     * @param Phase2 Phase with positive field values
+     * @param min Smallest voxel indices of the box
+     * @param max Largest voxel indices of the box
+     * @param Field [out] Smoothed field
+     */
+    void ComputeField(int Phase1, int Phase2, const std :: array< int, 3 > &min, const std :: array< int, 3 > &max, FieldType &Field);
+
+    /**
+     * @brief Evaluates a field by trilinear interpolation between voxel centers
+     * @param Field Field
+     * @param x Coordinate
+     * @param Gradient [out] Gradient of field at x
+     * @return Field value at x
+     */
+    double EvaluateField(const FieldType &Field, const std :: array< double, 3 > &x, std :: array< double, 3 > &Gradient) const;
+
+    void PrintParameters(std :: ostream &stream) const;
+
+public:
+    /**
+     * @brief Constructor
+     * @param Imp Importer with the voxel data
+     * @param sigma Standard deviation of the Gaussian filter, in voxels
+     * @param passes Number of projection steps
+     */
+    SignedDistanceSmoother(Importer *Imp, double sigma, int passes);
+    ~SignedDistanceSmoother() {}
+
+    void Smooth(std :: vector< VertexType * >Vertices, MeshData *Mesh = NULL);
+};
+
+}
+#endif
@@ -1,80 +1,322 @@
+#include <map>
+#include <chrono>
+
 #include "Smoother.h"
 
 namespace voxel2tet
 {
 
-std::vector<std::vector<VertexType *>> Smoother::GetConnectivityVector(std::vector<VertexType *> Vertices)
+void Smoother::GetConnectivity(std :: vector< VertexType * > &Vertices, std :: vector< VertexType * > &LocalVertices,
+                               std :: vector< int > &ConnectionStart, std :: vector< int > &ConnectionIndex)
 {
-    std::vector<std::vector<VertexType *>> Connectivity;
-    for (VertexType *v: Vertices) {
-        std::vector<VertexType *> ConnectedVertices;
-
-        // If v belongs to several phase edges, it is static and should not be effected by any other vertices
-        if (!v->IsFixedVertex()) {
-            // This will contain all connected vertices. Depending on type of v, some other vertices will be removed
-
-            for (EdgeType *e: v->Edges) {
-                if (!e->IsTransverse) {
-                    for (VertexType *ve: e->Vertices) {
-                        ConnectedVertices.push_back(ve);
-                    }
+    std :: unordered_map< VertexType *, int >LocalIndices;
+    LocalIndices.reserve( Vertices.size() );
+    LocalVertices.clear();
+
+    auto GiveLocalIndex = [ & ](VertexType * v) {
+                              auto it = LocalIndices.find(v);
+                              if ( it != LocalIndices.end() ) {
+                                  return it->second;
+                              }
+                              int Index = LocalVertices.size();
+                              LocalIndices [ v ] = Index;
+                              LocalVertices.push_back(v);
+                              return Index;
+                          };
+
+    for ( VertexType *v : Vertices ) {
+        GiveLocalIndex(v);
+    }
+    Vertices = LocalVertices;
+
+    // Each vertex is connected to the other vertex of each of its edges, unless the edge is transverse. If the vertex
+    // belongs to several phase edges, it is static and not connected to any vertices. If it belongs to one phase edge, it
+    // is only connected to vertices on the same phase edge.
+    ConnectionStart.assign(Vertices.size() + 1, 0);
+    ConnectionIndex.clear();
+    std :: vector< VertexType * >ConnectedVertices;
+    for ( size_t i = 0; i < Vertices.size(); i++ ) {
+        VertexType *v = Vertices [ i ];
+        ConnectedVertices.clear();
+
+        if ( !v->IsFixedVertex() ) {
+            PhaseEdge *pe = v->IsPhaseEdgeVertex() ? v->PhaseEdges [ 0 ] : NULL;
+            for ( EdgeType *e : v->Edges ) {
+                if ( e->IsTransverse ) {
+                    continue;
+                }
+                VertexType *v2 = ( e->Vertices [ 0 ] == v ) ? e->Vertices [ 1 ] : e->Vertices [ 0 ];
+                if ( ( v2 == v ) || ( pe && ( std :: find( v2->PhaseEdges.begin(), v2->PhaseEdges.end(), pe ) == v2->PhaseEdges.end() ) ) ) {
+                    continue;
                 }
+                ConnectedVertices.push_back(v2);
             }
 
-            // Remove duplicate vertices
-            std::sort(ConnectedVertices.begin(), ConnectedVertices.end());
+            // Remove duplicates. The connections are sorted by address as they always have been, which keeps the
+            // summation order, and thus the results, of the smoothers unchanged.
+            std :: sort( ConnectedVertices.begin(), ConnectedVertices.end() );
             ConnectedVertices.erase( std :: unique( ConnectedVertices.begin(), ConnectedVertices.end() ), ConnectedVertices.end() );
+        }
+
+        for ( VertexType *Connection : ConnectedVertices ) {
+            ConnectionIndex.push_back( GiveLocalIndex(Connection) );
+        }
+        ConnectionStart [ i + 1 ] = ConnectionIndex.size();
+    }
+}
+
+double Smoother::ComputeVolumeChange(std :: vector< VertexType * > &Vertices, const std :: vector< std :: array< double, 3 > > &StartPositions)
+{
+    std :: unordered_map< VertexType *, const std :: array< double, 3 > * >Start;
+    Start.reserve( Vertices.size() );
+    std :: vector< TriangleType * >Triangles;
+    for ( size_t i = 0; i < Vertices.size(); i++ ) {
+        Start [ Vertices [ i ] ] = & StartPositions [ i ];
+        Triangles.insert( Triangles.end(), Vertices [ i ]->Triangles.begin(), Vertices [ i ]->Triangles.end() );
+    }
+    std :: sort( Triangles.begin(), Triangles.end() );
+    Triangles.erase( std :: unique( Triangles.begin(), Triangles.end() ), Triangles.end() );
 
-            // Remove self
-            ConnectedVertices.erase(std::remove(ConnectedVertices.begin(), ConnectedVertices.end(), v), ConnectedVertices.end());
-
-            // If v is on a PhaseEdge, v should not be effected by vertices not belonging to the same PhaseEdge
-            if (v->IsPhaseEdgeVertex()) {
-
-                size_t i=0;
-                while (i<ConnectedVertices.size()) {
-                    VertexType *v2=ConnectedVertices[i];
-                    if (!v2->IsPhaseEdgeVertex()) {
-                        // v2 does not belong to any PhaseEdge
-                        ConnectedVertices.erase(std::remove(ConnectedVertices.begin(), ConnectedVertices.end(), v2), ConnectedVertices.end());
-                    } else {
-                        // v2 belongs to a PhaseEdge. If it belongs to some other PhaseEdge, remove it.
-                        bool BelongToSamePhaseEdge = false;
-                        for (PhaseEdge *pe: v2->PhaseEdges) {
-                            if (pe==v->PhaseEdges[0]) {
-                                BelongToSamePhaseEdge = true;
-                                break;
-                            }
-                        }
-                        if (!BelongToSamePhaseEdge) {
-                            ConnectedVertices.erase(std::remove(ConnectedVertices.begin(), ConnectedVertices.end(), v2), ConnectedVertices.end());
-                        } else {
-                            i++;
-                        }
-                    }
+    // Net volume moved into the phase with the largest ID of each surface
+    std :: map< std :: pair< int, int >, double >SurfaceVolumes;
+
+    for ( TriangleType *t : Triangles ) {
+        std :: array< std :: array< double, 3 >, 3 >a, d;
+        for ( int k = 0; k < 3; k++ ) {
+            VertexType *v = t->Vertices [ k ];
+            std :: array< double, 3 >c = v->get_c();
+            auto it = Start.find(v);
+            a [ k ] = ( it == Start.end() ) ? c : * it->second;
+            for ( int j = 0; j < 3; j++ ) {
+                d [ k ] [ j ] = c [ j ] - a [ k ] [ j ];
+            }
+        }
+
+        // The area vector is quadratic in time for a linear motion, thus Simpson's rule is exact. Since the velocity is
+        // linear over the triangle, the swept volume is the mean velocity times the integrated area vector.
+        std :: array< double, 3 >A = { { 0.0, 0.0, 0.0 } };
+        const double SimpsonTimes [ 3 ] = { 0.0, 0.5, 1.0 };
+        const double SimpsonWeights [ 3 ] = { 1.0 / 6.0, 4.0 / 6.0, 1.0 / 6.0 };
+        for ( int s = 0; s < 3; s++ ) {
+            std :: array< double, 3 >p [ 3 ];
+            for ( int k = 0; k < 3; k++ ) {
+                for ( int j = 0; j < 3; j++ ) {
+                    p [ k ] [ j ] = a [ k ] [ j ] + SimpsonTimes [ s ] * d [ k ] [ j ];
                 }
             }
+            double e1 [ 3 ] = { p [ 1 ] [ 0 ] - p [ 0 ] [ 0 ], p [ 1 ] [ 1 ] - p [ 0 ] [ 1 ], p [ 1 ] [ 2 ] - p [ 0 ] [ 2 ] };
+            double e2 [ 3 ] = { p [ 2 ] [ 0 ] - p [ 0 ] [ 0 ], p [ 2 ] [ 1 ] - p [ 0 ] [ 1 ], p [ 2 ] [ 2 ] - p [ 0 ] [ 2 ] };
+            A [ 0 ] = A [ 0 ] + SimpsonWeights [ s ] * 0.5 * ( e1 [ 1 ] * e2 [ 2 ] - e1 [ 2 ] * e2 [ 1 ] );
+            A [ 1 ] = A [ 1 ] + SimpsonWeights [ s ] * 0.5 * ( e1 [ 2 ] * e2 [ 0 ] - e1 [ 0 ] * e2 [ 2 ] );
+            A [ 2 ] = A [ 2 ] + SimpsonWeights [ s ] * 0.5 * ( e1 [ 0 ] * e2 [ 1 ] - e1 [ 1 ] * e2 [ 0 ] );
+        }
 
+        double Swept = 0.0;
+        for ( int j = 0; j < 3; j++ ) {
+            Swept = Swept + A [ j ] * ( d [ 0 ] [ j ] + d [ 1 ] [ j ] + d [ 2 ] [ j ] ) / 3.0;
+        }
+
+        // Moving along the normal increases the volume on the negative side of the triangle
+        std :: pair< int, int >Surface = std :: minmax(t->PosNormalMatID, t->NegNormalMatID);
+        SurfaceVolumes [ Surface ] = SurfaceVolumes [ Surface ] + ( ( t->NegNormalMatID > t->PosNormalMatID ) ? Swept : -Swept );
+    }
+
+    double VolumeChange = 0.0;
+    for ( auto &s : SurfaceVolumes ) {
+        VolumeChange = VolumeChange + std :: fabs(s.second);
+    }
+    return VolumeChange;
+}
+
+void Smoother::AddStatistics(std :: vector< VertexType * > &Vertices, const std :: vector< std :: array< double, 3 > > &StartPositions, int Iterations, double Time)
+{
+    double VolumeChange = this->ComputeVolumeChange(Vertices, StartPositions);
+    STATUS("\tSmoothed %zu vertices in %i iterations, %f s, volume change %e\n", Vertices.size(), Iterations, Time, VolumeChange);
+#pragma omp critical (SmootherStatistics)
+    this->Statistics.push_back({ Vertices.size(), Iterations, Time, VolumeChange });
+}
+
+std :: vector< std :: pair< TriangleType *, TriangleType * > > Smoother::CheckPenetration(std :: vector< VertexType * > *Vertices, MeshData *Mesh)
+{
+    std :: vector< std :: pair< TriangleType *, TriangleType * > >IntersectingTriangles;
+    SpatialQueryBuffer Buffer;
+    Mesh->FindIntersectingTriangles(* Vertices, IntersectingTriangles, Buffer);
+    return IntersectingTriangles;
+}
+
+void Smoother::RepairPenetration(std :: vector< std :: pair< TriangleType *, TriangleType * > > &IntersectingTriangles, MeshData *Mesh)
+{
+    const int MAX_GROW_COUNT = 1000;
+    const int BISECTIONS = 10;
+
+    // Vertices of the intersecting triangles, and their smoothed positions
+    std :: vector< VertexType * >Patch;
+    std :: unordered_map< VertexType *, std :: array< double, 3 > >SmoothedPositions;
 
-            // Finally, ensure that the referenced vertices exists in the list
-/*            size_t i=0;
-            while (i<ConnectedVertices.size()) {
-                if (std::find(Vertices.begin(), Vertices.end(), ConnectedVertices[i]) == Vertices.end()) {
-                    // Connected vertex does not exists in list. Remove.
-                    ConnectedVertices.erase(std::remove(ConnectedVertices.begin(), ConnectedVertices.end(), ConnectedVertices[i]), ConnectedVertices.end());
-                } else {
-                    i++;
+    auto AddToPatch = [ & ](std :: vector< std :: pair< TriangleType *, TriangleType * > > &Pairs) {
+                          for ( std :: pair< TriangleType *, TriangleType * >p : Pairs ) {
+                              for ( TriangleType *t : { p.first, p.second } ) {
+                                  for ( VertexType *v : t->Vertices ) {
+                                      if ( SmoothedPositions.find(v) == SmoothedPositions.end() ) {
+                                          SmoothedPositions [ v ] = v->get_c();
+                                          Patch.push_back(v);
+                                      }
+                                  }
+                              }
+                          }
+                      };
+
+    // Move the patch back to the original positions. If this still intersects other triangles, e.g. triangles of vertices
+    // smoothed towards the patch, add the vertices of those triangles to the patch.
+    AddToPatch(IntersectingTriangles);
+    int growcount = 0;
+    while ( IntersectingTriangles.size() > 0 ) {
+        if ( growcount++ > MAX_GROW_COUNT ) {
+            STATUS("Unable to remove intersecting triangles by moving %zu vertices back\n", Patch.size());
+            throw( 0 );
+        }
+
+        for ( VertexType *v : Patch ) {
+            for ( int i = 0; i < 3; i++ ) {
+                v->set_c(v->originalcoordinates [ i ], i);
+            }
+        }
+        IntersectingTriangles = this->CheckPenetration(& Patch, Mesh);
+        AddToPatch(IntersectingTriangles);
+    }
+
+    STATUS("\tMoved %zu vertices back to original positions\n", Patch.size());
+
+    // For each vertex, find by bisection the largest part of the smoothing displacement which does not cause any of the
+    // triangles of the vertex to intersect. Only these triangles are tested.
+    std :: vector< VertexType * >Moved(1);
+    for ( VertexType *v : Patch ) {
+        Moved [ 0 ] = v;
+        std :: array< double, 3 > &Smoothed = SmoothedPositions [ v ];
+
+        auto SetPosition = [ & ](double s) {
+                               for ( int i = 0; i < 3; i++ ) {
+                                   v->set_c(v->originalcoordinates [ i ] + s * ( Smoothed [ i ] - v->originalcoordinates [ i ] ), i);
+                               }
+                           };
+
+        SetPosition(1.0);
+        if ( this->CheckPenetration(& Moved, Mesh).size() == 0 ) {
+            continue;
+        }
+
+        double lo = 0.0, hi = 1.0;
+        for ( int k = 0; k < BISECTIONS; k++ ) {
+            double mid = 0.5 * ( lo + hi );
+            SetPosition(mid);
+            if ( this->CheckPenetration(& Moved, Mesh).size() == 0 ) {
+                lo = mid;
+            } else {
+                hi = mid;
+            }
+        }
+
+        SetPosition(lo);
+        Mesh->UpdateVertexPositions(Moved);
+    }
+}
+
+void Smoother::UpdateAndRepair(std :: vector< VertexType * > &Vertices, const std :: vector< std :: array< double, 3 > > &Positions,
+                               const std :: vector< std :: array< double, 3 > > &StartPositions, MeshData *Mesh)
+{
+    // Several sets of unconnected vertices may be smoothed concurrently (see Voxel2TetClass::SmoothSurfaces). Writing the
+    // positions of the smoothed vertices and all access to the spatial structures of the mesh is serialized by this
+    // critical section. An exception cannot leave the critical section, thus a failed repair is flagged and thrown
+    // afterwards.
+    bool failed = false;
+#pragma omp critical (SmootherMeshAccess)
+    {
+        std :: vector< VertexType * >MovedVertices;
+        for ( size_t i = 0; i < Vertices.size(); i++ ) {
+            for ( int j = 0; j < 3; j++ ) {
+                Vertices [ i ]->set_c(Positions [ i ] [ j ], j);
+            }
+            if ( Positions [ i ] != StartPositions [ i ] ) {
+                MovedVertices.push_back(Vertices [ i ]);
+            }
+        }
+
+        if ( this->DeferRepair ) {
+            this->DeferredVertices.insert( this->DeferredVertices.end(), MovedVertices.begin(), MovedVertices.end() );
+        } else {
+            // Check for intersecting triangles of the vertices which have moved. If some triangles intersect, move the
+            // vertices involved back towards their original positions.
+            std :: vector< std :: pair< TriangleType *, TriangleType * > >IntersectingTriangles = this->CheckPenetration(& MovedVertices, Mesh);
+            if ( IntersectingTriangles.size() > 0 ) {
+                STATUS("Repair surface/edge due to %zu intersecting triangles\n", IntersectingTriangles.size());
+                try {
+                    this->RepairPenetration(IntersectingTriangles, Mesh);
+                } catch ( ... ) {
+                    failed = true;
                 }
-            }*/
+            }
         }
-        Connectivity.push_back(ConnectedVertices);
     }
-    return Connectivity;
+
+    if ( failed ) {
+        throw( 0 );
+    }
 }
 
-Smoother::Smoother()
+void Smoother::RepairDeferred(MeshData *Mesh)
 {
+    std :: chrono :: steady_clock :: time_point starttime = std :: chrono :: steady_clock :: now();
+
+    // The order in which the vertices were added depends on the order in which concurrent calls finished
+    std :: sort( this->DeferredVertices.begin(), this->DeferredVertices.end() );
+    this->DeferredVertices.erase( std :: unique( this->DeferredVertices.begin(), this->DeferredVertices.end() ), this->DeferredVertices.end() );
+
+    std :: vector< std :: pair< TriangleType *, TriangleType * > >IntersectingTriangles = this->CheckPenetration(& this->DeferredVertices, Mesh);
+    if ( IntersectingTriangles.size() > 0 ) {
+        STATUS("Repair surface/edge due to %zu intersecting triangles\n", IntersectingTriangles.size());
+
+        std :: vector< std :: array< double, 3 > >StartPositions;
+        for ( VertexType *v : this->DeferredVertices ) {
+            StartPositions.push_back( v->get_c() );
+        }
+
+        this->RepairPenetration(IntersectingTriangles, Mesh);
+
+        // The calls to Smooth have already been recorded. Record the volume changed by the repair as a separate call
+        // without iterations.
+        double time = std :: chrono :: duration< double >(std :: chrono :: steady_clock :: now() - starttime).count();
+        this->AddStatistics(this->DeferredVertices, StartPositions, 0, time);
+    }
+    this->DeferredVertices.clear();
+}
 
+std :: ostream &operator<<(std :: ostream &stream, const Smoother &Smoother)
+{
+    Smoother.PrintParameters(stream);
+
+    // Iterations, time and volume change for each call to Smooth
+    size_t TotalIterations = 0;
+    double TotalTime = 0.0;
+    double TotalVolumeChange = 0.0;
+    for ( const Smoother :: SmoothingStatisticsType &s : Smoother.Statistics ) {
+        TotalIterations = TotalIterations + s.Iterations;
+        TotalTime = TotalTime + s.Time;
+        TotalVolumeChange = TotalVolumeChange + s.VolumeChange;
+    }
+    stream << "\tSmoothing calls = " << Smoother.Statistics.size() << ", iterations = " << TotalIterations << ", time = " << TotalTime << "s";
+    stream << ", volume change = " << TotalVolumeChange << "\n";
+    if ( Smoother.Statistics.size() > 0 ) {
+        stream << "\tVertices\tIterations\tTime\tVolume change\n";
+        for ( const Smoother :: SmoothingStatisticsType &s : Smoother.Statistics ) {
+            stream << "\t" << s.NumberOfVertices << "\t" << s.Iterations << "\t" << s.Time << "s\t" << s.VolumeChange << "\n";
+        }
+    }
+    return stream;
+}
+
+Smoother::Smoother()
+{
+    this->DeferRepair = false;
 }
 
 }
@@ -2,6 +2,10 @@
 #define SMOOTHER_H
 
 #include <vector>
+#include <array>
+#include <ostream>
+#include <algorithm>
+#include <unordered_map>
 
 #include "MeshComponents.h"
 #include "MeshData.h"
@@ -14,13 +18,103 @@ namespace voxel2tet
  */
 class Smoother
 {
+    friend std :: ostream &operator<<(std :: ostream &stream, const Smoother &Smoother);
+protected:
+    // Number of vertices, iterations, time (s) and volume change of each call to Smooth
+    struct SmoothingStatisticsType {
+        size_t NumberOfVertices;
+        int Iterations;
+        double Time;
+        double VolumeChange;
+    };
+    std :: vector< SmoothingStatisticsType >Statistics;
+
+    // Vertices moved by calls to Smooth while DeferRepair is set
+    std :: vector< VertexType * >DeferredVertices;
+
+    /**
+     * @brief Connectivity of a set of vertices in compressed row format, built in linear time. Each vertex is connected to
+     * the vertices sharing an edge which is not transverse. Vertices on several phase edges are not connected to any
+     * vertex and vertices on one phase edge only to vertices on the same phase edge. All involved vertices are given a
+     * dense local numbering. The vertices in Vertices are numbered first, i.e. Vertices[i] has local index i,
+     * followed by the connected vertices not in Vertices. The connections of Vertices[i] are
+     * ConnectionIndex[ConnectionStart[i]] to ConnectionIndex[ConnectionStart[i+1]-1].
+     * @param Vertices [in, out] Vertices to smooth. Duplicates are removed.
+     * @param LocalVertices [out] All involved vertices, in local order
+     * @param ConnectionStart [out] Start of connections of each vertex
+     * @param ConnectionIndex [out] Local indices of connected vertices
+     */
+    void GetConnectivity(std :: vector< VertexType * > &Vertices, std :: vector< VertexType * > &LocalVertices,
+                         std :: vector< int > &ConnectionStart, std :: vector< int > &ConnectionIndex);
+
+    /**
+     * @brief Computes the volume moved between phases when vertices are moved. The volume swept by each triangle of the
+     * vertices is computed exactly for a linear motion of the vertices. The net volume is summed for each pair of phases,
+     * i.e. each surface.
+     * @param Vertices Moved vertices
+     * @param StartPositions Positions of the vertices before moving
+     * @return Sum of the absolute values of the net volume moved across each surface
+     */
+    double ComputeVolumeChange(std :: vector< VertexType * > &Vertices, const std :: vector< std :: array< double, 3 > > &StartPositions);
+
+    /**
+     * @brief Adds statistics for a call to Smooth. Safe to call from concurrent calls to Smooth.
+     * @param Vertices Smoothed vertices
+     * @param StartPositions Positions of the vertices before smoothing
+     * @param Iterations Number of iterations
+     * @param Time Time (s)
+     */
+    void AddStatistics(std :: vector< VertexType * > &Vertices, const std :: vector< std :: array< double, 3 > > &StartPositions, int Iterations, double Time);
+
+    // Intersecting pairs of triangles where at least one triangle is connected to any of the given, moved, vertices
+    std :: vector< std :: pair< TriangleType *, TriangleType * > >CheckPenetration(std :: vector< VertexType * > *Vertices, MeshData *Mesh);
+
+    /**
+     * @brief Removes intersections by moving vertices back towards their original positions. First, the vertices of the
+     * intersecting triangles are moved back to their original positions, adding vertices of triangles still intersecting
+     * until no intersections remain. Then, for each vertex, the largest part of its displacement which does not cause its
+     * triangles to intersect is found by bisection. Only triangles of moved vertices are tested.
+     * @param IntersectingTriangles [in, out] Intersecting pairs of triangles. Empty on return.
+     * @param Mesh Mesh containing the triangles
+     */
+    void RepairPenetration(std :: vector< std :: pair< TriangleType *, TriangleType * > > &IntersectingTriangles, MeshData *Mesh);
+
+    /**
+     * @brief Copies smoothed positions to the vertices and repairs any intersections caused, unless DeferRepair is set.
+     * Safe to call from concurrent calls to Smooth.
+     * @param Vertices Smoothed vertices
+     * @param Positions Smoothed positions of the vertices
+     * @param StartPositions Positions of the vertices before smoothing
+     * @param Mesh Mesh containing the vertices
+     */
+    void UpdateAndRepair(std :: vector< VertexType * > &Vertices, const std :: vector< std :: array< double, 3 > > &Positions,
+                         const std :: vector< std :: array< double, 3 > > &StartPositions, MeshData *Mesh);
+
+    /**
+     * @brief Writes the name and parameters of the smoother
+     * @param stream Output stream
+     */
+    virtual void PrintParameters(std :: ostream &stream) const = 0;
+
 public:
     /**
      * @brief constructor
      */
     Smoother();
+    virtual ~Smoother() {}
+
+    /**
+     * @brief If true, Smooth only moves the vertices and leaves the check for intersecting triangles to RepairDeferred.
+     * Concurrent calls to Smooth then never move vertices smoothed by another call.
+     */
+    bool DeferRepair;
 
-    std::vector<std::vector<VertexType *>> GetConnectivityVector(std::vector<VertexType *> Vertices);
+    /**
+     * @brief Checks for intersecting triangles of all vertices moved by Smooth while DeferRepair was set, and repairs them
+     * as in Smooth. The repair is recorded in the statistics as a separate call.
+     * @param Mesh Mesh containing the vertices
+     */
+    void RepairDeferred(MeshData *Mesh);
 
     /**
      * @brief Smooth all given vertices.
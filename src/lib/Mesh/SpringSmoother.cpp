@@ -12,6 +12,11 @@ SpringSmoother::SpringSmoother(double VoxelCharLength, double c, double alpha, d
     this->alpha = alpha;
     this->charlength = VoxelCharLength;
     this->c_factor = c_factor;
+    this->GaussSeidel = false;
+    this->Global = false;
+    this->Multilevel = false;
+    this->AndersonDepth = 0;
+    this->ActiveSet = false;
 
     if (compute_c) {
         this->c = this->Compute_c(VoxelCharLength * c_factor, this->alpha);
@@ -46,408 +51,837 @@ double SpringSmoother::Compute_c(double l, double alpha)
     return c;
 }
 
-arma :: vec SpringSmoother::ComputeOutOfBalance(std :: vector< std :: array< double, 3 > >ConnectionCoords, arma :: vec xc, arma :: vec x0, double alpha, double c)
+void SpringSmoother::ComputeOutOfBalance(const std :: vector< std :: array< double, 3 > > &Positions, const int *Connections, int NumberOfConnections,
+                                         const std :: array< double, 3 > &xc, const std :: array< double, 3 > &x0, double alpha, double c, std :: array< double, 3 > &R,
+                                         double Weight)
 {
-    arma :: vec F = {
-        0., 0., 0.
+    // Nonlinear part of force
+    double a0 [ 3 ] = {
+        x0 [ 0 ] - xc [ 0 ], x0 [ 1 ] - xc [ 1 ], x0 [ 2 ] - xc [ 2 ]
     };
-
-    // Compute nonlinear part of force
-    arma :: vec n0;
-
-    double d0 = arma :: norm(x0 - xc);
-    if ( d0 < 1e-8 ) {
-        n0 = {
-            0., 0., 0.
-        };
-    } else {
-        n0 = ( x0 - xc ) / d0;
+    double d0 = std :: sqrt(a0 [ 0 ] * a0 [ 0 ] + a0 [ 1 ] * a0 [ 1 ] + a0 [ 2 ] * a0 [ 2 ]);
+    double f0 = 0.0;
+    if ( d0 >= 1e-8 ) {
+        f0 = Weight * ( std :: exp( std :: pow(d0 / c, alpha) ) - 1 ) / d0;
     }
 
-    F = ( exp( pow(d0 / c, alpha) ) - 1 ) * n0;
-
-    // Compute linear part of force
-    for ( unsigned int i = 0; i < ConnectionCoords.size(); i++ ) {
-        arma :: vec xi = {
-            ConnectionCoords.at(i) [ 0 ], ConnectionCoords.at(i) [ 1 ], ConnectionCoords.at(i) [ 2 ]
+    // Linear part of force. Springs shorter than 1e-8 give no force.
+    for ( int j = 0; j < 3; j++ ) {
+        R [ j ] = f0 * a0 [ j ];
+    }
+    for ( int i = 0; i < NumberOfConnections; i++ ) {
+        const std :: array< double, 3 > &xi = Positions [ Connections [ i ] ];
+        double aj [ 3 ] = {
+            xi [ 0 ] - xc [ 0 ], xi [ 1 ] - xc [ 1 ], xi [ 2 ] - xc [ 2 ]
         };
-        arma :: vec nj;
-        double dj = arma :: norm(xi - xc);
-        if ( dj < 1e-8 ) {
-            nj = {
-                0., 0., 0.,
-            };
-        } else {
-            nj = ( xi - xc ) / dj;
+        if ( aj [ 0 ] * aj [ 0 ] + aj [ 1 ] * aj [ 1 ] + aj [ 2 ] * aj [ 2 ] >= 1e-16 ) {
+            for ( int j = 0; j < 3; j++ ) {
+                R [ j ] = R [ j ] + aj [ j ];
+            }
         }
-        F = F + dj * nj;
     }
-
-    return F;
 }
 
-arma :: mat  SpringSmoother::ComputeNumericalTangent(std :: vector< std :: array< double, 3 > >ConnectionCoords, arma :: vec xc, arma :: vec x0, double alpha, double c)
+void SpringSmoother::ComputeAnalyticalTangent(const std :: array< double, 3 > &xc, const std :: array< double, 3 > &x0, int NumberOfConnections,
+                                              double alpha, double c, std :: array< std :: array< double, 3 >, 3 > &T, double Weight)
 {
-    double eps = 1e-10;
-    arma :: mat Tangent = arma :: zeros< arma :: mat >(3, 3);
+    // Linear part
+    for ( int i = 0; i < 3; i++ ) {
+        for ( int j = 0; j < 3; j++ ) {
+            T [ i ] [ j ] = ( i == j ) ? -double(NumberOfConnections) : 0.0;
+        }
+    }
 
-    arma :: vec Fval = ComputeOutOfBalance(ConnectionCoords, xc, x0, alpha, c);
+    // Non-linear part. In the case of d0=0, everyting nonlinear is zero.
+    double a0 [ 3 ] = {
+        x0 [ 0 ] - xc [ 0 ], x0 [ 1 ] - xc [ 1 ], x0 [ 2 ] - xc [ 2 ]
+    };
+    double d0 = std :: sqrt(a0 [ 0 ] * a0 [ 0 ] + a0 [ 1 ] * a0 [ 1 ] + a0 [ 2 ] * a0 [ 2 ]);
+    if ( d0 < 1e-8 ) {
+        return;
+    }
 
+    double e = std :: exp( std :: pow(d0 / c, alpha) );
+
+    // n0*Dexp' + Dn0*(e-1) with Dexp = -e*alpha/c*(d0/c)^(alpha-1)*n0 and Dn0 = -I/d0 + a0*a0'/d0^3
+    double Dexp = -e * alpha / c * std :: pow(d0 / c, alpha - 1);
+    double nn = Weight * ( Dexp / ( d0 * d0 ) + ( e - 1 ) / ( d0 * d0 * d0 ) );
     for ( int i = 0; i < 3; i++ ) {
-        arma :: vec xi = xc;
-        xi [ i ] = xi [ i ] + eps;
-        arma :: vec Fvali = ComputeOutOfBalance(ConnectionCoords, xi, x0, alpha, c);
-        arma :: vec dF = ( Fvali - Fval ) / eps;
-        Tangent.col(i) = dF;
+        for ( int j = 0; j < 3; j++ ) {
+            T [ i ] [ j ] = T [ i ] [ j ] + nn * a0 [ i ] * a0 [ j ];
+        }
+        T [ i ] [ i ] = T [ i ] [ i ] - Weight * ( e - 1 ) / d0;
     }
-
-    return Tangent;
 }
 
-arma :: mat SpringSmoother::ComputeAnalyticalTangent(std :: vector< std :: array< double, 3 > >ConnectionCoords, arma :: vec xc, arma :: vec x0, double alpha, double c)
+int SpringSmoother::FindEquilibrium(const std :: vector< std :: array< double, 3 > > &Positions, const int *Connections, int NumberOfConnections,
+                                    std :: array< double, 3 > &xc, const std :: array< double, 3 > &x0, double c, const std :: array< double, 3 > *Force,
+                                    double Weight)
 {
-    arma :: mat Tangent = arma :: zeros< arma :: mat >(3, 3);
+    const int MAX_ITER = 1000;
+    const int MAX_HALVINGS = 30;
 
-    arma :: vec a0 = x0 - xc;
-    double d0 = arma :: norm(a0);
-    arma :: vec n0;
+    std :: array< double, 3 >R, Rnew, xnew, delta;
+    std :: array< std :: array< double, 3 >, 3 >T;
 
-    // Non-linear part
-    // We run into numerical trouble if d0=0. However, in the case of d0=0, everyting nonlinear is zero...
-    arma :: vec Dexp;
-    arma :: mat Dn0;
-    if ( d0 < 1e-8 ) {
-        n0 = {
-            0., 0., 0.
-        };
-        Dexp = {
-            0., 0., 0.
-        };
-        Dn0 = -arma :: zeros< arma :: mat >(3, 3);
-    } else {
-        n0 = a0 / d0;
-        Dexp = -std :: exp( std :: pow(d0 / c, alpha) ) * alpha / c *pow(d0 / c, alpha - 1) * n0;
-        Dn0 = -arma :: eye< arma :: mat >(3, 3) / d0 + a0 *a0.t() / pow(d0, 3);
+    this->ComputeOutOfBalance(Positions, Connections, NumberOfConnections, xc, x0, this->alpha, c, R, Weight);
+    if ( Force != NULL ) {
+        for ( int i = 0; i < 3; i++ ) {
+            R [ i ] = R [ i ] + ( * Force ) [ i ];
+        }
     }
-    Tangent = Tangent + n0 *Dexp.t() + Dn0 * ( std :: exp( std :: pow(d0 / c, alpha) ) - 1 );
+    double err = std :: sqrt(R [ 0 ] * R [ 0 ] + R [ 1 ] * R [ 1 ] + R [ 2 ] * R [ 2 ]);
 
+    int iter = 0;
+    while ( ( err > 1e-5 ) & ( iter < MAX_ITER ) ) {
+        this->ComputeAnalyticalTangent(xc, x0, NumberOfConnections, this->alpha, c, T, Weight);
 
-    // Linear part
-    Tangent = Tangent - arma :: eye< arma :: mat >(3, 3) * ConnectionCoords.size();
+        // Solve T*delta = -R using the adjugate of T
+        std :: array< std :: array< double, 3 >, 3 >A;
+        for ( int i = 0; i < 3; i++ ) {
+            int i1 = ( i + 1 ) % 3, i2 = ( i + 2 ) % 3;
+            for ( int j = 0; j < 3; j++ ) {
+                int j1 = ( j + 1 ) % 3, j2 = ( j + 2 ) % 3;
+                A [ j ] [ i ] = T [ i1 ] [ j1 ] * T [ i2 ] [ j2 ] - T [ i1 ] [ j2 ] * T [ i2 ] [ j1 ];
+            }
+        }
+        double det = T [ 0 ] [ 0 ] * A [ 0 ] [ 0 ] + T [ 0 ] [ 1 ] * A [ 1 ] [ 0 ] + T [ 0 ] [ 2 ] * A [ 2 ] [ 0 ];
 
-    return Tangent;
+        if ( std :: fabs(det) > 1e-300 ) {
+            for ( int i = 0; i < 3; i++ ) {
+                delta [ i ] = -( A [ i ] [ 0 ] * R [ 0 ] + A [ i ] [ 1 ] * R [ 1 ] + A [ i ] [ 2 ] * R [ 2 ] ) / det;
+            }
+        } else {
+            // Singular tangent. The tangent is otherwise negative definite, thus step along the out-of-balance force.
+            for ( int i = 0; i < 3; i++ ) {
+                delta [ i ] = R [ i ] / std :: max(NumberOfConnections, 1);
+            }
+        }
+
+        // Damping: Halve the step until the out-of-balance force decreases. If no step decreases it, xc is kept.
+        double errnew = err;
+        bool decreased = false;
+        for ( int k = 0; k < MAX_HALVINGS; k++ ) {
+            for ( int i = 0; i < 3; i++ ) {
+                xnew [ i ] = xc [ i ] + delta [ i ];
+            }
+            this->ComputeOutOfBalance(Positions, Connections, NumberOfConnections, xnew, x0, this->alpha, c, Rnew, Weight);
+            if ( Force != NULL ) {
+                for ( int i = 0; i < 3; i++ ) {
+                    Rnew [ i ] = Rnew [ i ] + ( * Force ) [ i ];
+                }
+            }
+            errnew = std :: sqrt(Rnew [ 0 ] * Rnew [ 0 ] + Rnew [ 1 ] * Rnew [ 1 ] + Rnew [ 2 ] * Rnew [ 2 ]);
+            if ( errnew < err ) {
+                decreased = true;
+                break;
+            }
+            for ( int i = 0; i < 3; i++ ) {
+                delta [ i ] = delta [ i ] * 0.5;
+            }
+        }
+
+        if ( !decreased ) {
+            break;
+        }
+
+        xc = xnew;
+        R = Rnew;
+        err = errnew;
+        iter++;
+    }
+
+    // If too many iterations, throw an exception and investigate...
+    if ( err > 1e-5 ) {
+        STATUS("Unable to find equilibrium for vertex, error=%e after %i iterations\n", err, iter);
+        throw( 0 );
+    }
+
+    return iter;
 }
 
-arma :: mat SpringSmoother::ComputeAnalyticalTangentGlobal(std :: vector< std :: array< double, 3 > >ConnectionCoords, arma :: vec xc, arma :: vec x0, double alpha, double c)
+int SpringSmoother::SolveCG(const std :: vector< int > &RowStart, const std :: vector< int > &Columns, const std :: vector< double > &Values,
+                            const std :: vector< double > &b, std :: vector< double > &x, double tol, int maxiter)
 {
-    arma :: mat Tangent = arma :: zeros< arma :: mat >(3, ConnectionCoords.size() * 3 + 3);
-    arma :: mat TangentSelf = arma :: zeros< arma :: mat >(3, 3);
-
-    arma :: vec a0 = x0 - xc;
-    double d0 = arma :: norm(a0);
-    arma :: vec n0;
+    int n = b.size();
+
+    // Jacobi preconditioner
+    std :: vector< double >InvDiagonal(n, 1.0);
+    for ( int i = 0; i < n; i++ ) {
+        for ( int k = RowStart [ i ]; k < RowStart [ i + 1 ]; k++ ) {
+            if ( ( Columns [ k ] == i ) && ( Values [ k ] != 0.0 ) ) {
+                InvDiagonal [ i ] = 1.0 / Values [ k ];
+            }
+        }
+    }
 
-    // delta x_i part
+    std :: vector< double >r(n), z(n), p(n), Ap(n);
+    double bnorm2 = 0.0, rz = 0.0;
+
+#pragma omp parallel for reduction(+:bnorm2, rz)
+    for ( int i = 0; i < n; i++ ) {
+        x [ i ] = 0.0;
+        r [ i ] = b [ i ];
+        z [ i ] = InvDiagonal [ i ] * r [ i ];
+        p [ i ] = z [ i ];
+        bnorm2 = bnorm2 + b [ i ] * b [ i ];
+        rz = rz + r [ i ] * z [ i ];
+    }
 
-    // Non-linear part
-    // We run into numerical trouble if d0=0. However, in the case of d0=0, everyting nonlinear is zero...
-    arma :: vec Dexp;
-    arma :: mat Dn0;
-    if ( d0 < 1e-8 ) {
-        n0 = {
-            0., 0., 0.
-        };
-        Dexp = {
-            0., 0., 0.
-        };
-        Dn0 = -arma :: zeros< arma :: mat >(3, 3);
-    } else {
-        n0 = a0 / d0;
-        Dexp = -std :: exp( std :: pow(d0 / c, alpha) ) * alpha / c *pow(d0 / c, alpha - 1) * n0;
-        Dn0 = -arma :: eye< arma :: mat >(3, 3) / d0 + a0 *a0.t() / pow(d0, 3);
+    if ( bnorm2 == 0.0 ) {
+        return 0;
     }
-    TangentSelf = n0 * Dexp.t() + Dn0 * ( std :: exp( std :: pow(d0 / c, alpha) ) - 1 );
 
-    // Linear part
-    TangentSelf = TangentSelf - arma :: eye< arma :: mat >(3, 3) * ConnectionCoords.size();
+    int iter = 0;
+    double rnorm2 = bnorm2;
+    while ( ( rnorm2 > tol * tol * bnorm2 ) & ( iter < maxiter ) ) {
+        double pAp = 0.0;
+#pragma omp parallel for reduction(+:pAp)
+        for ( int i = 0; i < n; i++ ) {
+            double v = 0.0;
+            for ( int k = RowStart [ i ]; k < RowStart [ i + 1 ]; k++ ) {
+                v = v + Values [ k ] * p [ Columns [ k ] ];
+            }
+            Ap [ i ] = v;
+            pAp = pAp + p [ i ] * v;
+        }
 
-    // Assemble self part to tangent
-    Tangent( arma :: span(0, 2), arma :: span(0, 2) ) = TangentSelf;
+        if ( pAp <= 0.0 ) {
+            // Not positive definite in this direction. Keep the current solution.
+            break;
+        }
 
-    // delta x_j part
-    for ( unsigned int i = 0; i < ConnectionCoords.size(); i++ ) {
-        for ( int j = 0; j < 3; j++ ) {
-            Tangent(j, 3 * ( i + 1 ) + j) = 1.0; // /ConnectionCoords.size();
+        double a = rz / pAp;
+        double rznew = 0.0;
+        rnorm2 = 0.0;
+#pragma omp parallel for reduction(+:rznew, rnorm2)
+        for ( int i = 0; i < n; i++ ) {
+            x [ i ] = x [ i ] + a * p [ i ];
+            r [ i ] = r [ i ] - a * Ap [ i ];
+            z [ i ] = InvDiagonal [ i ] * r [ i ];
+            rznew = rznew + r [ i ] * z [ i ];
+            rnorm2 = rnorm2 + r [ i ] * r [ i ];
         }
+
+        double beta = rznew / rz;
+        rz = rznew;
+#pragma omp parallel for
+        for ( int i = 0; i < n; i++ ) {
+            p [ i ] = z [ i ] + beta * p [ i ];
+        }
+        iter++;
     }
-    return Tangent;
+
+    return iter;
 }
 
-void SpringSmoother::SpringSmoothGlobal(std :: vector< VertexType * >Vertices, std :: vector< bool >Fixed, std :: vector< std :: vector< VertexType * > >Connections, double c, double alpha, double charlength, bool Automatic_c, voxel2tet :: MeshData *Mesh)
+int SpringSmoother::SolveGlobal(std :: vector< VertexType * > &Vertices, const std :: vector< int > &ConnectionStart, const std :: vector< int > &ConnectionIndex,
+                                const std :: vector< std :: array< double, 3 > > &OriginalPositions, std :: vector< std :: array< double, 3 > > &Positions)
 {
-    int MAX_ITER_COUNT = 1000;
-
-    //Fixed.at(0)=true;
+    const int MAX_NEWTON_ITER = 100;
+    const int MAX_HALVINGS = 30;
+    int n = Vertices.size();
 
-    if ( Automatic_c ) {
-        // c = Compute_c(charlength);
+    // Degrees of freedom. Vertices without connections, e.g. fixed vertices, keep their positions.
+    std :: vector< std :: array< int, 3 > >DofIDs(n);
+    int ndof = 0;
+    for ( int i = 0; i < n; i++ ) {
+        for ( int k = 0; k < 3; k++ ) {
+            if ( ( ConnectionStart [ i + 1 ] > ConnectionStart [ i ] ) && !Vertices [ i ]->Fixed [ k ] ) {
+                DofIDs [ i ] [ k ] = ndof++;
+            } else {
+                DofIDs [ i ] [ k ] = -1;
+            }
+        }
     }
 
-    // Create vectors for current and previous positions
-    std :: vector< std :: array< double, 3 > >CurrentPositions;
-    std :: vector< std :: array< int, 3 > >dofids;
-
-    int ndof = 0;
+    if ( ndof == 0 ) {
+        return 0;
+    }
 
-    for ( unsigned int i = 0; i < Vertices.size(); i++ ) {
-        std :: array< double, 3 >cp;
-        std :: array< int, 3 >dofid = { { -1, -1, -1 } };
-        for ( int j = 0; j < 3; j++ ) {
-            cp.at(j) = Vertices.at(i)->get_c(j);
-            if ( !Fixed [ i ] ) {
-                if ( !Vertices.at(i)->Fixed [ j ] ) {
-                    dofid [ j ] = ndof;
-                    ndof++;
+    // The tangent is only symmetric if all connections between vertices with degrees of freedom are mutual
+    for ( int i = 0; i < n; i++ ) {
+        for ( int k = ConnectionStart [ i ]; k < ConnectionStart [ i + 1 ]; k++ ) {
+            int j = ConnectionIndex [ k ];
+            if ( ( j < n ) && ( ConnectionStart [ j + 1 ] > ConnectionStart [ j ] ) ) {
+                const int *begin = ConnectionIndex.data() + ConnectionStart [ j ];
+                const int *end = ConnectionIndex.data() + ConnectionStart [ j + 1 ];
+                if ( std :: find(begin, end, i) == end ) {
+                    STATUS("\tConnectivity is not symmetric. Use local smoothing.\n", 0);
+                    return -1;
                 }
             }
         }
-        CurrentPositions.push_back(cp);
-        dofids.push_back(dofid);
     }
 
-    // Create vector-vector for accessing neightbours
-    std :: vector< std :: vector< int > >ConnectionVertexIndex;
-    for ( std :: vector< VertexType * >n : Connections ) {
-        ConnectionVertexIndex.push_back({});
-        for ( VertexType *v : n ) {
-            int VertexIndex = std :: distance( Vertices.begin(), std :: find(Vertices.begin(), Vertices.end(), v) );
-            ConnectionVertexIndex.at(ConnectionVertexIndex.size() - 1).push_back(VertexIndex);
+    // Sparsity pattern of the negative tangent K in compressed row format. The 3x3 block of each vertex changes between
+    // iterations, the coupling to connected vertices is constant (-1 for the same direction).
+    std :: vector< int >RowStart(ndof + 1, 0);
+    std :: vector< int >Columns;
+    std :: vector< double >Values;
+    std :: vector< std :: array< std :: array< int, 3 >, 3 > >BlockPositions(n);
+    for ( int i = 0; i < n; i++ ) {
+        for ( int k = 0; k < 3; k++ ) {
+            for ( int m = 0; m < 3; m++ ) {
+                BlockPositions [ i ] [ k ] [ m ] = -1;
+            }
+            if ( DofIDs [ i ] [ k ] == -1 ) {
+                continue;
+            }
+            for ( int m = 0; m < 3; m++ ) {
+                if ( DofIDs [ i ] [ m ] != -1 ) {
+                    BlockPositions [ i ] [ k ] [ m ] = Columns.size();
+                    Columns.push_back(DofIDs [ i ] [ m ]);
+                    Values.push_back(0.0);
+                }
+            }
+            for ( int c = ConnectionStart [ i ]; c < ConnectionStart [ i + 1 ]; c++ ) {
+                int j = ConnectionIndex [ c ];
+                if ( ( j < n ) && ( DofIDs [ j ] [ k ] != -1 ) ) {
+                    Columns.push_back(DofIDs [ j ] [ k ]);
+                    Values.push_back(-1.0);
+                }
+            }
+            RowStart [ DofIDs [ i ] [ k ] + 1 ] = Columns.size();
         }
     }
 
-#if EXPORT_SMOOTHING_ANIMATION == 1
-    std :: ostringstream FileName;
-    if ( Mesh != NULL ) {
-        FileName << "/tmp/Smoothing" << 0 << ".vtp";
-        Mesh->ExportSurface(FileName.str(), FT_VTK);
-    }
-#endif
+    // Out-of-balance forces for all degrees of freedom. Returns the largest force for any vertex.
+    auto ComputeResidual = [ & ](const std :: vector< std :: array< double, 3 > > &x, std :: vector< double > &R) {
+                               double MaxForce = 0.0;
+#pragma omp parallel for reduction(max:MaxForce)
+                               for ( int i = 0; i < n; i++ ) {
+                                   std :: array< double, 3 >Ri;
+                                   this->ComputeOutOfBalance(x, ConnectionIndex.data() + ConnectionStart [ i ], ConnectionStart [ i + 1 ] - ConnectionStart [ i ],
+                                                             x [ i ], OriginalPositions [ i ], this->alpha, Vertices [ i ]->c_constant, Ri);
+                                   double Force = 0.0;
+                                   for ( int k = 0; k < 3; k++ ) {
+                                       if ( DofIDs [ i ] [ k ] != -1 ) {
+                                           R [ DofIDs [ i ] [ k ] ] = Ri [ k ];
+                                           Force = Force + Ri [ k ] * Ri [ k ];
+                                       }
+                                   }
+                                   MaxForce = std :: max(MaxForce, std :: sqrt(Force) );
+                               }
+                               return MaxForce;
+                           };
+
+    std :: vector< double >R(ndof), Rtrial(ndof), delta(ndof);
+    std :: vector< std :: array< double, 3 > >Trial = Positions;
+
+    double err = ComputeResidual(Positions, R);
+    int iter = 0;
+    while ( ( err > 1e-5 ) & ( iter < MAX_NEWTON_ITER ) ) {
+        // Assemble the vertex blocks of K
+#pragma omp parallel for
+        for ( int i = 0; i < n; i++ ) {
+            std :: array< std :: array< double, 3 >, 3 >T;
+            this->ComputeAnalyticalTangent(Positions [ i ], OriginalPositions [ i ], ConnectionStart [ i + 1 ] - ConnectionStart [ i ],
+                                           this->alpha, Vertices [ i ]->c_constant, T);
+            for ( int k = 0; k < 3; k++ ) {
+                for ( int m = 0; m < 3; m++ ) {
+                    if ( BlockPositions [ i ] [ k ] [ m ] != -1 ) {
+                        Values [ BlockPositions [ i ] [ k ] [ m ] ] = -T [ k ] [ m ];
+                    }
+                }
+            }
+        }
 
-    int itercount = 0;
-    double err = 1e8;
+        // Newton step, K*delta = R
+        int cgiter = this->SolveCG(RowStart, Columns, Values, R, delta, 1e-8, 10 * ndof + 100);
 
-    arma :: sp_mat Kff(ndof, ndof);
-    arma :: vec Rf = arma :: ones< arma :: vec >(ndof);
+        // Limit the step to the characteristic length
+        double MaxDelta = 0.0;
+        for ( double d : delta ) {
+            MaxDelta = std :: max( MaxDelta, std :: fabs(d) );
+        }
+        double scale = ( MaxDelta > this->charlength ) ? this->charlength / MaxDelta : 1.0;
+
+        // Halve the step until the out-of-balance forces decrease. If no step decreases them, stop at the current iterate.
+        double errtrial = err;
+        bool decreased = false;
+        for ( int h = 0; h < MAX_HALVINGS; h++ ) {
+            for ( int i = 0; i < n; i++ ) {
+                for ( int k = 0; k < 3; k++ ) {
+                    if ( DofIDs [ i ] [ k ] != -1 ) {
+                        Trial [ i ] [ k ] = Positions [ i ] [ k ] + scale * delta [ DofIDs [ i ] [ k ] ];
+                    }
+                }
+            }
+            errtrial = ComputeResidual(Trial, Rtrial);
+            if ( errtrial < err ) {
+                decreased = true;
+                break;
+            }
+            scale = scale * 0.5;
+        }
 
-    while ( ( itercount < MAX_ITER_COUNT ) & ( err > 1e-6 ) ) {
-        Kff.zeros();
+        if ( !decreased ) {
+            break;
+        }
 
-        for ( size_t i = 0; i < Vertices.size(); i++ ) {
-            if ( !Fixed [ i ] ) {
-                std :: vector< std :: array< double, 3 > >ConnectionCoords;
-                std :: vector< VertexType * >MyConnections = Connections.at(i);
-
-                for ( unsigned k = 0; k < MyConnections.size(); k++ ) {
-                    ConnectionCoords.push_back({ CurrentPositions.at( ConnectionVertexIndex.at(i).at(k) ) [ 0 ],
-                                                 CurrentPositions.at( ConnectionVertexIndex.at(i).at(k) ) [ 1 ],
-                                                 CurrentPositions.at( ConnectionVertexIndex.at(i).at(k) ) [ 2 ] });
-                }
+        std :: copy( Trial.begin(), Trial.begin() + n, Positions.begin() );
+        R.swap(Rtrial);
+        err = errtrial;
+        iter++;
 
-                arma :: vec xc = {
-                    CurrentPositions.at(i) [ 0 ], CurrentPositions.at(i) [ 1 ], CurrentPositions.at(i) [ 2 ]
-                };
-                arma :: vec x0 = {
-                    Vertices.at(i)->get_c(0), Vertices.at(i)->get_c(1), Vertices.at(i)->get_c(2)
-                };
+        STATUS("%c[2K\r\tGlobal iteration %u end with err=%e after %u CG iterations\r", 27, iter, err, cgiter);
+        fflush(stdout);
+    }
 
-                // Assemble out-of-balance vector
-                arma :: vec R = ComputeOutOfBalance(ConnectionCoords, xc, x0, alpha, c);
+    if ( err > 1e-5 ) {
+        STATUS("\n\tGlobal smoothing did not converge, err=%e. Continue with local smoothing.\n", err);
+        return -2;
+    }
 
-                for ( int j = 0; j < 3; j++ ) {
-                    if ( dofids [ i ] [ j ] != -1 ) { // Not stationary
-                        Rf [ dofids [ i ] [ j ] ] = R [ j ];
+    return iter;
+}
+
+void SpringSmoother::ComputeMultilevelGuess(std :: vector< VertexType * > &Vertices, const std :: vector< int > &ConnectionStart, const std :: vector< int > &ConnectionIndex,
+                                            const std :: vector< std :: array< double, 3 > > &OriginalPositions, std :: vector< std :: array< double, 3 > > &Positions)
+{
+    const int MIN_COARSE_VERTICES = 50;
+    const int PRE_SWEEPS = 2;
+    const int MAX_ITER_COUNT = 10000;
+
+    // A level consists of n vertices to smooth followed by the vertices they connect to but which are not smoothed.
+    // Aggregate maps each vertex of the finer level to a vertex of this level. Weight scales the force from the original
+    // position and Force is added to the out-of-balance force, such that each level approximates the sum of the
+    // equations of the vertices in each aggregate (full approximation scheme).
+    struct LevelType {
+        int n;
+        std :: vector< int >ConnectionStart;
+        std :: vector< int >ConnectionIndex;
+        std :: vector< int >Aggregate;
+        std :: vector< std :: array< bool, 3 > >Fixed;
+        std :: vector< double >c;
+        std :: vector< double >Weight;
+        std :: vector< std :: array< double, 3 > >Force;
+        std :: vector< std :: array< double, 3 > >OriginalPositions;
+        std :: vector< std :: array< double, 3 > >StartPositions;
+        std :: vector< std :: array< double, 3 > >Positions;
+    };
+
+    // Gauss-Seidel sweep over a level. Returns the largest change of any coordinate.
+    auto Sweep = [ this ](LevelType &Level) {
+                     double deltamax = 0.0;
+                     for ( int i = 0; i < Level.n; i++ ) {
+                         std :: array< double, 3 >xc = Level.Positions [ i ];
+                         this->FindEquilibrium(Level.Positions, Level.ConnectionIndex.data() + Level.ConnectionStart [ i ],
+                                               Level.ConnectionStart [ i + 1 ] - Level.ConnectionStart [ i ], xc, Level.OriginalPositions [ i ],
+                                               Level.c [ i ], & Level.Force [ i ], Level.Weight [ i ]);
+                         for ( int k = 0; k < 3; k++ ) {
+                             if ( !Level.Fixed [ i ] [ k ] ) {
+                                 deltamax = std :: max( deltamax, std :: fabs(xc [ k ] - Level.Positions [ i ] [ k ]) );
+                                 Level.Positions [ i ] [ k ] = xc [ k ];
+                             }
+                         }
+                     }
+                     return deltamax;
+                 };
+
+    // Mean length of the connections of a level
+    auto MeanLength = [](const LevelType &Level, const std :: vector< std :: array< double, 3 > > &x) {
+                          double l = 0.0;
+                          for ( int i = 0; i < Level.n; i++ ) {
+                              for ( int k = Level.ConnectionStart [ i ]; k < Level.ConnectionStart [ i + 1 ]; k++ ) {
+                                  const std :: array< double, 3 > &xj = x [ Level.ConnectionIndex [ k ] ];
+                                  l = l + std :: sqrt( ( xj [ 0 ] - x [ i ] [ 0 ] ) * ( xj [ 0 ] - x [ i ] [ 0 ] ) + ( xj [ 1 ] - x [ i ] [ 1 ] ) * ( xj [ 1 ] - x [ i ] [ 1 ] ) +
+                                                       ( xj [ 2 ] - x [ i ] [ 2 ] ) * ( xj [ 2 ] - x [ i ] [ 2 ] ) );
+                              }
+                          }
+                          return l / std :: max(Level.ConnectionStart [ Level.n ], 1);
+                      };
+
+    std :: vector< LevelType >Levels(1);
+    Levels [ 0 ].n = Vertices.size();
+    Levels [ 0 ].ConnectionStart = ConnectionStart;
+    Levels [ 0 ].ConnectionIndex = ConnectionIndex;
+    Levels [ 0 ].OriginalPositions = OriginalPositions;
+    Levels [ 0 ].Positions = Positions;
+    Levels [ 0 ].Weight.assign(Positions.size(), 1.0);
+    Levels [ 0 ].Force.assign(Positions.size(), { { 0.0, 0.0, 0.0 } });
+    for ( VertexType *v : Vertices ) {
+        Levels [ 0 ].Fixed.push_back({ { v->Fixed [ 0 ], v->Fixed [ 1 ], v->Fixed [ 2 ] } });
+        Levels [ 0 ].c.push_back(v->c_constant);
+    }
+
+    try {
+        // Coarsen by aggregating each vertex with its neighbours until the levels are small or no longer shrink
+        while ( Levels.back().n > MIN_COARSE_VERTICES ) {
+            LevelType &Fine = Levels.back();
+            LevelType Coarse;
+            int n = Fine.n;
+            int m = Fine.Positions.size();
+
+            // Remove the local variations first, these cannot be represented on the coarse level
+            for ( int k = 0; k < PRE_SWEEPS; k++ ) {
+                Sweep(Fine);
+            }
+
+            // Aggregate vertices whose neighbours are all unaggregated, then add remaining vertices to a neighbouring aggregate
+            std :: vector< int >Aggregate(m, -1);
+            int nc = 0;
+            for ( int i = 0; i < n; i++ ) {
+                bool Unaggregated = ( Aggregate [ i ] == -1 );
+                for ( int k = Fine.ConnectionStart [ i ]; Unaggregated & ( k < Fine.ConnectionStart [ i + 1 ] ); k++ ) {
+                    int j = Fine.ConnectionIndex [ k ];
+                    Unaggregated = ( j >= n ) || ( Aggregate [ j ] == -1 );
+                }
+                if ( Unaggregated ) {
+                    Aggregate [ i ] = nc;
+                    for ( int k = Fine.ConnectionStart [ i ]; k < Fine.ConnectionStart [ i + 1 ]; k++ ) {
+                        int j = Fine.ConnectionIndex [ k ];
+                        if ( j < n ) {
+                            Aggregate [ j ] = nc;
+                        }
                     }
+                    nc++;
                 }
+            }
+            for ( int i = 0; i < n; i++ ) {
+                for ( int k = Fine.ConnectionStart [ i ]; ( Aggregate [ i ] == -1 ) & ( k < Fine.ConnectionStart [ i + 1 ] ); k++ ) {
+                    int j = Fine.ConnectionIndex [ k ];
+                    if ( ( j < n ) && ( Aggregate [ j ] != -1 ) ) {
+                        Aggregate [ i ] = Aggregate [ j ];
+                    }
+                }
+                if ( Aggregate [ i ] == -1 ) {
+                    Aggregate [ i ] = nc++;
+                }
+            }
+            if ( 2 * nc > n ) {
+                break;
+            }
 
-                // Assemble to tangent
-                std :: vector< int >ConnectionIndices = ConnectionVertexIndex.at(i);
-                arma :: mat T = ComputeAnalyticalTangent(ConnectionCoords, xc, x0, alpha, c);
-
-                std :: vector< int >Rows = {
-                    dofids [ i ] [ 0 ], dofids [ i ] [ 1 ], dofids [ i ] [ 2 ]
-                };
-                std :: vector< int >Cols = {
-                    dofids [ i ] [ 0 ], dofids [ i ] [ 1 ], dofids [ i ] [ 2 ]
-                };
+            // Vertices which are not smoothed remain as they are
+            for ( int i = n; i < m; i++ ) {
+                Aggregate [ i ] = nc + i - n;
+            }
 
-                for ( int index : ConnectionIndices ) {
-                    for ( int j = 0; j < 3; j++ ) {
-                        Cols.push_back(dofids [ index ] [ j ]);
+            int mc = nc + m - n;
+            Coarse.n = nc;
+            Coarse.Aggregate = Aggregate;
+            Coarse.Fixed.assign(mc, { { false, false, false } });
+            Coarse.c.assign(mc, 0.0);
+            Coarse.Weight.assign(mc, 0.0);
+            Coarse.Force.assign(mc, { { 0.0, 0.0, 0.0 } });
+            Coarse.OriginalPositions.assign(mc, { { 0.0, 0.0, 0.0 } });
+            Coarse.StartPositions.assign(mc, { { 0.0, 0.0, 0.0 } });
+
+            // Aggregates are fixed in a direction if any of their vertices is and take the mean positions and constants
+            std :: vector< int >Count(mc, 0);
+            for ( int i = 0; i < m; i++ ) {
+                int a = Aggregate [ i ];
+                Count [ a ]++;
+                for ( int k = 0; k < 3; k++ ) {
+                    Coarse.OriginalPositions [ a ] [ k ] += Fine.OriginalPositions [ i ] [ k ];
+                    Coarse.StartPositions [ a ] [ k ] += Fine.Positions [ i ] [ k ];
+                }
+                if ( i < n ) {
+                    Coarse.c [ a ] += Fine.c [ i ];
+                    Coarse.Weight [ a ] += Fine.Weight [ i ];
+                    for ( int k = 0; k < 3; k++ ) {
+                        Coarse.Fixed [ a ] [ k ] = Coarse.Fixed [ a ] [ k ] | Fine.Fixed [ i ] [ k ];
                     }
                 }
+            }
+            for ( int a = 0; a < mc; a++ ) {
+                Coarse.c [ a ] = Coarse.c [ a ] / Count [ a ];
+                for ( int k = 0; k < 3; k++ ) {
+                    Coarse.OriginalPositions [ a ] [ k ] = Coarse.OriginalPositions [ a ] [ k ] / Count [ a ];
+                    Coarse.StartPositions [ a ] [ k ] = Coarse.StartPositions [ a ] [ k ] / Count [ a ];
+                }
+            }
+            Coarse.Positions = Coarse.StartPositions;
 
-                for ( int j = 0; j < 3; j++ ) {
-                    if ( Rows [ j ] != -1 ) {
-                        for ( size_t k = 0; k < Cols.size(); k++ ) {
-                            if ( Cols [ k ] != -1 ) {
-                                Kff(Rows [ j ], Cols [ k ]) = Kff(Rows [ j ], Cols [ k ]) + T(j, k);
-                            }
+            // Aggregates are connected once for each connection between their vertices, thus the sum of the linear forces
+            // on the vertices of an aggregate equals the linear force on the aggregate
+            std :: vector< std :: vector< int > >Members(nc);
+            for ( int i = 0; i < n; i++ ) {
+                Members [ Aggregate [ i ] ].push_back(i);
+            }
+            Coarse.ConnectionStart.push_back(0);
+            for ( int a = 0; a < nc; a++ ) {
+                for ( int i : Members [ a ] ) {
+                    for ( int k = Fine.ConnectionStart [ i ]; k < Fine.ConnectionStart [ i + 1 ]; k++ ) {
+                        int b = Aggregate [ Fine.ConnectionIndex [ k ] ];
+                        if ( b != a ) {
+                            Coarse.ConnectionIndex.push_back(b);
                         }
                     }
                 }
+                Coarse.ConnectionStart.push_back( Coarse.ConnectionIndex.size() );
             }
-        }
-
-        //Kff.print("Kff = ");
 
-        err = arma :: norm(Rf);
-        //Rf.print("Rf = ");
+            // The connections between aggregates are longer than those between vertices, while the linear force on each
+            // connection is the difference in position. Scale all other forces accordingly.
+            double Scale = MeanLength(Coarse, Coarse.StartPositions) / MeanLength(Fine, Fine.Positions);
+            for ( int a = 0; a < nc; a++ ) {
+                Coarse.Weight [ a ] = Coarse.Weight [ a ] * Scale;
+            }
 
-        arma :: vec delta; // = arma::spsolve(Kff, -Rf);
-        delta.zeros(ndof);
-        //delta.print("delta:");
+            // The additional force on each aggregate is the sum of the out-of-balance forces of its vertices less its own
+            // out-of-balance force, at the start positions
+            for ( int i = 0; i < n; i++ ) {
+                std :: array< double, 3 >R;
+                this->ComputeOutOfBalance(Fine.Positions, Fine.ConnectionIndex.data() + Fine.ConnectionStart [ i ], Fine.ConnectionStart [ i + 1 ] - Fine.ConnectionStart [ i ],
+                                          Fine.Positions [ i ], Fine.OriginalPositions [ i ], this->alpha, Fine.c [ i ], R, Fine.Weight [ i ]);
+                for ( int k = 0; k < 3; k++ ) {
+                    Coarse.Force [ Aggregate [ i ] ] [ k ] += Scale * ( R [ k ] + Fine.Force [ i ] [ k ] );
+                }
+            }
+            for ( int a = 0; a < nc; a++ ) {
+                std :: array< double, 3 >R;
+                this->ComputeOutOfBalance(Coarse.Positions, Coarse.ConnectionIndex.data() + Coarse.ConnectionStart [ a ], Coarse.ConnectionStart [ a + 1 ] - Coarse.ConnectionStart [ a ],
+                                          Coarse.Positions [ a ], Coarse.OriginalPositions [ a ], this->alpha, Coarse.c [ a ], R, Coarse.Weight [ a ]);
+                for ( int k = 0; k < 3; k++ ) {
+                    Coarse.Force [ a ] [ k ] -= R [ k ];
+                }
+            }
 
+            Levels.push_back(Coarse);
+        }
 
-        // Solve system using CG algorihtm
-        int maxiter = 10000000;
+        if ( Levels.size() == 1 ) {
+            std :: copy( Levels [ 0 ].Positions.begin(), Levels [ 0 ].Positions.begin() + Vertices.size(), Positions.begin() );
+            return;
+        }
 
-        arma :: vec r = -Rf - Kff * delta;
-        arma :: vec rn;
-        arma :: vec p = r;
+        STATUS("\tMultilevel smoothing using %zu levels, %i vertices on the coarsest\n", Levels.size(), Levels.back().n);
 
-        for ( int i = 0; i < maxiter; i++ ) {
-            arma :: vec Ap = Kff * p;
+        // Smooth each coarse level, from the coarsest, and add the displacements of the aggregates to the next finer level
+        for ( size_t l = Levels.size() - 1; l > 0; l-- ) {
+            LevelType &Level = Levels [ l ];
+            LevelType &Fine = Levels [ l - 1 ];
 
-            double alpha = arma :: as_scalar(r.t() * r) / arma :: as_scalar(p.t() * Ap);
-            delta = delta + alpha * p;
-            rn = r - alpha * Ap;
-            double residual = arma :: norm(r);
-            if ( residual < 1e-8 ) {
-                break;
+            int itercount = 0;
+            while ( ( itercount < MAX_ITER_COUNT ) && ( Sweep(Level) > ( charlength * 1e-3 ) ) ) {
+                itercount++;
             }
-            double beta = arma :: as_scalar(rn.t() * rn) / arma :: as_scalar(r.t() * r);
-            p = rn + beta * p;
-            r = rn;
-        }
 
-        if ( err > 1e-10 ) {
-            //delta.print("delta = ");
-            double maxdelta = arma :: max(delta);
-            if ( fabs(maxdelta) > 0.001 ) {
-                delta = delta * 0.001 / maxdelta;
+            for ( int i = 0; i < Fine.n; i++ ) {
+                int a = Level.Aggregate [ i ];
+                for ( int k = 0; k < 3; k++ ) {
+                    if ( !Fine.Fixed [ i ] [ k ] ) {
+                        Fine.Positions [ i ] [ k ] += Level.Positions [ a ] [ k ] - Level.StartPositions [ a ] [ k ];
+                    }
+                }
             }
         }
+    } catch ( ... ) {
+        STATUS("\tMultilevel smoothing failed. Start from the current positions.\n", 0);
+        return;
+    }
 
-        // Update current positions
-        for ( size_t i = 0; i < Vertices.size(); i++ ) {
-            for ( int j = 0; j < 3; j++ ) {
-                if ( dofids [ i ] [ j ] != -1 ) {
-                    CurrentPositions.at(i) [ j ] = CurrentPositions.at(i) [ j ] + delta [ dofids [ i ] [ j ] ];
-                }
+    std :: copy( Levels [ 0 ].Positions.begin(), Levels [ 0 ].Positions.begin() + Vertices.size(), Positions.begin() );
+}
+
+void SpringSmoother::AndersonMix(AndersonHistoryType &History, const std :: vector< std :: array< double, 3 > > &x,
+                                 std :: vector< std :: array< double, 3 > > &g, int n)
+{
+    int m = 3 * n;
+
+    // Residual of the sweep
+    std :: vector< double >f(m);
+    double fnorm2 = 0.0;
+#pragma omp parallel for reduction(+:fnorm2)
+    for ( int i = 0; i < m; i++ ) {
+        f [ i ] = g [ i / 3 ] [ i % 3 ] - x [ i / 3 ] [ i % 3 ];
+        fnorm2 = fnorm2 + f [ i ] * f [ i ];
+    }
+    double fnorm = std :: sqrt(fnorm2);
+
+    // Update history. If the residual has increased, the history is no longer useful. Restart with a plain sweep.
+    if ( History.gPrevious.size() == size_t( m ) ) {
+        if ( fnorm > History.fNormPrevious ) {
+            History.dG.clear();
+            History.dF.clear();
+        } else {
+            std :: vector< double >dg(m), df(m);
+#pragma omp parallel for
+            for ( int i = 0; i < m; i++ ) {
+                dg [ i ] = g [ i / 3 ] [ i % 3 ] - History.gPrevious [ i ];
+                df [ i ] = f [ i ] - History.fPrevious [ i ];
+            }
+            History.dG.push_back(dg);
+            History.dF.push_back(df);
+            if ( History.dG.size() > size_t( this->AndersonDepth ) ) {
+                History.dG.erase( History.dG.begin() );
+                History.dF.erase( History.dF.begin() );
             }
         }
+    }
 
-        STATUS("\tIteration %i end with err=%f\n", itercount, err);
+    History.gPrevious.resize(m);
+    for ( int i = 0; i < m; i++ ) {
+        History.gPrevious [ i ] = g [ i / 3 ] [ i % 3 ];
+    }
+    History.fPrevious = f;
+    History.fNormPrevious = fnorm;
 
-        itercount++;
+    int k = History.dF.size();
+    if ( k == 0 ) {
+        return;
+    }
 
-#if EXPORT_SMOOTHING_ANIMATION == 1
-        // ************************** DEBUG STUFF
-        // Update vertices
-        for ( unsigned int i = 0; i < Vertices.size(); i++ ) {
-            VertexType *v = Vertices.at(i);
-            for ( int j = 0; j < 3; j++ ) {
-                if ( !v->Fixed [ j ] ) {
-                    v->set_c(CurrentPositions.at(i) [ j ], j);
-                }
+    // Find the combination gamma of previous residual changes closest to the current residual, i.e. minimize
+    // |f-dF*gamma|, from the normal equations. The system is small and solved by Gaussian elimination.
+    std :: vector< std :: vector< double > >A( k, std :: vector< double >(k + 1, 0.0) );
+    for ( int r = 0; r < k; r++ ) {
+        for ( int s = r; s < k; s++ ) {
+            double v = 0.0;
+            const std :: vector< double > &dFr = History.dF [ r ], &dFs = History.dF [ s ];
+#pragma omp parallel for reduction(+:v)
+            for ( int i = 0; i < m; i++ ) {
+                v = v + dFr [ i ] * dFs [ i ];
             }
+            A [ r ] [ s ] = A [ s ] [ r ] = v;
         }
-
-        if ( Mesh != NULL ) {
-            FileName.str("");
-            FileName.clear();
-            FileName << "/tmp/Smoothing" << itercount++ << ".vtp";
-            Mesh->ExportSurface(FileName.str(), FT_VTK);
+        double v = 0.0;
+        const std :: vector< double > &dFr = History.dF [ r ];
+#pragma omp parallel for reduction(+:v)
+        for ( int i = 0; i < m; i++ ) {
+            v = v + dFr [ i ] * f [ i ];
         }
-        // ************************** /DEBUG STUFF
-#endif
+        A [ r ] [ k ] = v;
+    }
 
-#if TEST_MESH_FOR_EACH_SMOOTHING
-        TetGenCaller Tetgen;
-        Tetgen.Mesh = Mesh;
-        Tetgen.TestMesh();
-#endif
+    // Regularize to handle (nearly) linearly dependent history
+    double trace = 0.0;
+    for ( int r = 0; r < k; r++ ) {
+        trace = trace + A [ r ] [ r ];
+    }
+    for ( int r = 0; r < k; r++ ) {
+        A [ r ] [ r ] = A [ r ] [ r ] + 1e-10 * trace / k;
     }
 
-    if ( itercount > 999 ) {
-        STATUS("WARNING: Smoothing did not converge\n", 0);
+    for ( int r = 0; r < k; r++ ) {
+        int pivot = r;
+        for ( int s = r + 1; s < k; s++ ) {
+            if ( std :: fabs(A [ s ] [ r ]) > std :: fabs(A [ pivot ] [ r ]) ) {
+                pivot = s;
+            }
+        }
+        std :: swap(A [ r ], A [ pivot ]);
+        if ( std :: fabs(A [ r ] [ r ]) < 1e-300 ) {
+            return;
+        }
+        for ( int s = r + 1; s < k; s++ ) {
+            double factor = A [ s ] [ r ] / A [ r ] [ r ];
+            for ( int t = r; t <= k; t++ ) {
+                A [ s ] [ t ] = A [ s ] [ t ] - factor * A [ r ] [ t ];
+            }
+        }
+    }
+    std :: vector< double >gamma(k);
+    for ( int r = k - 1; r >= 0; r-- ) {
+        double v = A [ r ] [ k ];
+        for ( int s = r + 1; s < k; s++ ) {
+            v = v - A [ r ] [ s ] * gamma [ s ];
+        }
+        gamma [ r ] = v / A [ r ] [ r ];
     }
 
-    // Update vertices
-    for ( unsigned int i = 0; i < Vertices.size(); i++ ) {
-        for ( int j = 0; j < 3; j++ ) {
-            Vertices.at(i)->set_c(CurrentPositions.at(i) [ j ], j); // TODO: Use array to improve performance
+    // Mixed positions x = g - dG*gamma. Do not extrapolate further than the characteristic length.
+    std :: vector< double >step(m, 0.0);
+    double stepmax = 0.0;
+#pragma omp parallel for reduction(max:stepmax)
+    for ( int i = 0; i < m; i++ ) {
+        for ( int r = 0; r < k; r++ ) {
+            step [ i ] = step [ i ] - gamma [ r ] * History.dG [ r ] [ i ];
         }
+        stepmax = std :: max( stepmax, std :: fabs(step [ i ]) );
+    }
+
+    if ( stepmax > this->charlength ) {
+        History.dG.clear();
+        History.dF.clear();
+        return;
+    }
+
+#pragma omp parallel for
+    for ( int i = 0; i < m; i++ ) {
+        g [ i / 3 ] [ i % 3 ] = g [ i / 3 ] [ i % 3 ] + step [ i ];
     }
 }
 
-std :: vector< std :: pair< TriangleType *, TriangleType * > > SpringSmoother::CheckPenetration(std :: vector< VertexType * > *Vertices, MeshData *Mesh)
+void SpringSmoother::PrintParameters(std :: ostream &stream) const
 {
-    std :: vector< std :: pair< TriangleType *, TriangleType * > >IntersectingTriangles;
-    std :: vector< TriangleType * >Triangles;
-
-    for ( VertexType *v : *Vertices ) {
-        for ( TriangleType *t : v->Triangles ) {
-            Triangles.push_back(t);
-        }
-    }
-    std :: sort( Triangles.begin(), Triangles.end() );
-    Triangles.erase( std :: unique( Triangles.begin(), Triangles.end() ), Triangles.end() );
-
-    for ( TriangleType *t1 : Triangles ) {
-        std :: array< double, 3 >c = t1->GiveCenterOfMass();
-        double d = t1->GiveLongestEdgeLength();
-
-        std :: vector< TriangleType * >NearTriangles = Mesh->GetTrianglesAround(c, d * 2); // TODO: 2 should to it, but keep it in mind
-
-        for ( TriangleType *t2 : NearTriangles ) {
-            if ( t1 != t2 ) {
-                if ( Mesh->CheckTrianglePenetration(t1, t2) ) {
-                    //Mesh->CheckTrianglePenetration(t1, t2);
-                    IntersectingTriangles.push_back({ t1, t2 });
-                    LOG("Triangles %u and %u intersect!\n", t1->ID, t2->ID);
-                    LOG( "t1(%u): (%f, %f, %f), (%f, %f, %f), (%f, %f, %f)\n", t1->ID, t1->Vertices.at(0)->get_c(0), t1->Vertices.at(0)->get_c(1), t1->Vertices.at(0)->get_c(2),
-                         t1->Vertices.at(1)->get_c(0), t1->Vertices.at(1)->get_c(1), t1->Vertices.at(1)->get_c(2),
-                         t1->Vertices.at(2)->get_c(0), t1->Vertices.at(2)->get_c(1), t1->Vertices.at(2)->get_c(2) );
-                    LOG( "t2(%u): (%f, %f, %f), (%f, %f, %f), (%f, %f, %f)\n", t2->ID, t2->Vertices.at(0)->get_c(0), t2->Vertices.at(0)->get_c(1), t2->Vertices.at(0)->get_c(2),
-                         t2->Vertices.at(1)->get_c(0), t2->Vertices.at(1)->get_c(1), t2->Vertices.at(1)->get_c(2),
-                         t2->Vertices.at(2)->get_c(0), t2->Vertices.at(2)->get_c(1), t2->Vertices.at(2)->get_c(2) );
-                    /*
-                     *                  std::vector<VertexType*>  StiffenVertices;
-                     *
-                     *                  for (VertexType *v: t1->Vertices) StiffenVertices.push_back(v);
-                     *                  for (VertexType *v: t2->Vertices) StiffenVertices.push_back(v);
-                     *
-                     *                  std::sort(StiffenVertices.begin(), StiffenVertices.end());
-                     *                  StiffenVertices.erase(std::unique(StiffenVertices.begin(), StiffenVertices.end()), StiffenVertices.end());
-                     *
-                     *                  for (VertexType *v: StiffenVertices) {
-                     *                      //v->c_constant = v->c_constant * 0.75;
-                     *                      printf("(%u: c)=%f, ", v->ID, v->c_constant);
-                     *                  }
-                     *                  LOG("\n", 0);*/
-                }
+    stream << "\tSpring smoother\n";
+    stream << "\talpha = " << this->alpha << ", ";
+    stream << "c = " << this->c << ", c_factor = " << this->c_factor << "\n";
+    stream << "\tGaussSeidel = " << this->GaussSeidel << ", Global = " << this->Global << ", Multilevel = " << this->Multilevel;
+    stream << ", AndersonDepth = " << this->AndersonDepth << ", ActiveSet = " << this->ActiveSet << "\n";
+}
+
+void SpringSmoother::ColourVertices(const std :: vector< int > &ConnectionStart, const std :: vector< int > &ConnectionIndex,
+                                    std :: vector< int > &SweepOrder, std :: vector< int > &ColourStart)
+{
+    int n = ConnectionStart.size() - 1;
+
+    // Symmetric adjacency between the vertices to smooth. Connected vertices not smoothed (index >= n) are never updated
+    // and cannot cause conflicts.
+    std :: vector< int >AdjacencyStart(n + 1, 0);
+    for ( int i = 0; i < n; i++ ) {
+        for ( int k = ConnectionStart [ i ]; k < ConnectionStart [ i + 1 ]; k++ ) {
+            int j = ConnectionIndex [ k ];
+            if ( ( j < n ) && ( j != i ) ) {
+                AdjacencyStart [ i + 1 ]++;
+                AdjacencyStart [ j + 1 ]++;
             }
         }
     }
-    return IntersectingTriangles;
-}
+    for ( int i = 0; i < n; i++ ) {
+        AdjacencyStart [ i + 1 ] = AdjacencyStart [ i + 1 ] + AdjacencyStart [ i ];
+    }
 
-std::ostream &operator<<(std::ostream &stream, const SpringSmoother &Smoother)
-{
-    stream << "\talpha = " << Smoother.alpha << ", ";
-    stream << "c = " << Smoother.c << ", c_factor = " << Smoother.c_factor << "\n";
-    return stream;
+    std :: vector< int >Adjacency( AdjacencyStart [ n ] );
+    std :: vector< int >Position(AdjacencyStart.begin(), AdjacencyStart.end() - 1);
+    for ( int i = 0; i < n; i++ ) {
+        for ( int k = ConnectionStart [ i ]; k < ConnectionStart [ i + 1 ]; k++ ) {
+            int j = ConnectionIndex [ k ];
+            if ( ( j < n ) && ( j != i ) ) {
+                Adjacency [ Position [ i ]++ ] = j;
+                Adjacency [ Position [ j ]++ ] = i;
+            }
+        }
+    }
+
+    // Give each vertex the smallest colour not used by any neighbour. UsedBy[c] == i if colour c is used by a neighbour of i.
+    std :: vector< int >Colours(n, -1);
+    std :: vector< int >UsedBy;
+    for ( int i = 0; i < n; i++ ) {
+        for ( int k = AdjacencyStart [ i ]; k < AdjacencyStart [ i + 1 ]; k++ ) {
+            if ( Colours [ Adjacency [ k ] ] != -1 ) {
+                UsedBy [ Colours [ Adjacency [ k ] ] ] = i;
+            }
+        }
+
+        int Colour = 0;
+        while ( ( Colour < int( UsedBy.size() ) ) && ( UsedBy [ Colour ] == i ) ) {
+            Colour++;
+        }
+        if ( Colour == int( UsedBy.size() ) ) {
+            UsedBy.push_back(-1);
+        }
+        Colours [ i ] = Colour;
+    }
+
+    // Sort vertices by colour
+    ColourStart.assign(UsedBy.size() + 1, 0);
+    for ( int i = 0; i < n; i++ ) {
+        ColourStart [ Colours [ i ] + 1 ]++;
+    }
+    for ( size_t k = 0; k < UsedBy.size(); k++ ) {
+        ColourStart [ k + 1 ] = ColourStart [ k + 1 ] + ColourStart [ k ];
+    }
+
+    SweepOrder.resize(n);
+    Position.assign(ColourStart.begin(), ColourStart.end() - 1);
+    for ( int i = 0; i < n; i++ ) {
+        SweepOrder [ Position [ Colours [ i ] ]++ ] = i;
+    }
 }
 
 void SpringSmoother::Smooth(std :: vector< VertexType * >Vertices, voxel2tet :: MeshData *Mesh)
@@ -455,28 +889,54 @@ void SpringSmoother::Smooth(std :: vector< VertexType * >Vertices, voxel2tet ::
 
     int MAX_ITER_COUNT = 100000;
 
-    // Create connectivity vector/"matrix"
-    std::vector<std::vector<VertexType *>> NewConnections = this->GetConnectivityVector(Vertices);
+    std :: chrono :: steady_clock :: time_point starttime = std :: chrono :: steady_clock :: now();
 
-    // Create vectors for current and previous positions for all involved vertices (even those vertices connected to a vertex in Vertices vector)
-    std :: map<VertexType *, std :: array< double, 3 > >OriginalPositions;
-    std :: map<VertexType *, std :: array< double, 3 > >CurrentPositions;
-    std :: map<VertexType *, std :: array< double, 3 > >PreviousPositions;
+    // Dense local numbering of all involved vertices (even those vertices connected to a vertex in Vertices vector) and
+    // connections in compressed row format. The connections of Vertices[i] are ConnectionIndex[ConnectionStart[i]] to
+    // ConnectionIndex[ConnectionStart[i+1]-1].
+    std :: vector< VertexType * >LocalVertices;
+    std :: vector< int >ConnectionStart;
+    std :: vector< int >ConnectionIndex;
+    this->GetConnectivity(Vertices, LocalVertices, ConnectionStart, ConnectionIndex);
 
-    for (std::vector<VertexType *> VertexList: NewConnections) {
-        for (VertexType *v: VertexList) {
-            OriginalPositions[v] = v->get_c();
-            CurrentPositions[v] = v->get_c();
-            PreviousPositions[v] = v->get_c();
-        }
+    // Original, current and previous positions for all involved vertices
+    std :: vector< std :: array< double, 3 > >OriginalPositions( LocalVertices.size() );
+    for ( size_t i = 0; i < LocalVertices.size(); i++ ) {
+        OriginalPositions [ i ] = LocalVertices [ i ]->get_c();
     }
+    std :: vector< std :: array< double, 3 > >CurrentPositions = OriginalPositions;
+    std :: vector< std :: array< double, 3 > >PreviousPositions = OriginalPositions;
 
-    for (VertexType *v: Vertices) {
-        OriginalPositions[v] = v->get_c();
-        CurrentPositions[v] = v->get_c();
-        PreviousPositions[v] = v->get_c();
+#if EXPORT_SMOOTHING_ANIMATION == 1
+    // Copy positions to the vertices. The vertices are otherwise only updated when the smoothing has converged.
+    auto UpdateVertices = [ & ]() {
+                              for ( size_t i = 0; i < Vertices.size(); i++ ) {
+                                  for ( int j = 0; j < 3; j++ ) {
+                                      Vertices [ i ]->set_c(CurrentPositions [ i ] [ j ], j);
+                                  }
+                              }
+                          };
+#endif
+
+    // Order in which the vertices are updated. In Jacobi sweeps, all vertices are updated at once from the previous
+    // positions. In Gauss-Seidel sweeps, the vertices are grouped by colour and each colour is updated at once, using the
+    // positions already updated for the previous colours. Sweep k updates Vertices[SweepOrder[ColourStart[k]]] to
+    // Vertices[SweepOrder[ColourStart[k+1]-1]].
+    std :: vector< int >SweepOrder;
+    std :: vector< int >ColourStart;
+    if ( this->GaussSeidel ) {
+        this->ColourVertices(ConnectionStart, ConnectionIndex, SweepOrder, ColourStart);
+        STATUS("\tGauss-Seidel smoothing using %zu colours\n", ColourStart.size() - 1);
+    } else {
+        SweepOrder.resize( Vertices.size() );
+        for ( size_t i = 0; i < Vertices.size(); i++ ) {
+            SweepOrder [ i ] = i;
+        }
+        ColourStart = { 0, int( Vertices.size() ) };
     }
 
+    // In Gauss-Seidel sweeps, the positions are updated in place
+    std :: vector< std :: array< double, 3 > > &SweepPositions = this->GaussSeidel ? CurrentPositions : PreviousPositions;
 
     // Reset 'c' constant for all vertices
     for ( VertexType *v : Vertices ) {
@@ -491,213 +951,172 @@ void SpringSmoother::Smooth(std :: vector< VertexType * >Vertices, voxel2tet ::
     }
 #endif
 
+    int threadcount = 1;
 #ifdef OPENMP
     threadcount = omp_get_max_threads();
 #endif
 
-    bool intersecting = true;
-    int intersecting_count = 0;
+    int totalitercount = 0;
 
-    this->CheckPenetration(& Vertices, Mesh);
+    // The sweeps only read and write the local arrays. Updates of the mesh are serialized as in UpdateAndRepair.
+#pragma omp critical (SmootherMeshAccess)
+    Mesh->UpdateVertexPositions(Vertices);
 
-    while ( intersecting ) {
-        intersecting = false;
-        int itercount = 0;
-        int threadcount = 1;
-        double deltamax = 1e8;
-        int deltamaxnode;
+    int itercount = 0;
+    double deltamax = 1e8;
+    int deltamaxnode;
 
-        while ( ( itercount < MAX_ITER_COUNT ) & ( deltamax > ( charlength * 1e-3 ) ) ) {
-            deltamax = 0.0;
-            int deltamaxnodes [ threadcount ];
-            double deltamaxvalues [ threadcount ];
+    std :: vector< int >deltamaxnodes(threadcount);
+    std :: vector< double >deltamaxvalues(threadcount);
 
-            for ( int i = 0; i < threadcount; i++ ) {
-                deltamaxnodes [ i ] = 0;
-                deltamaxvalues [ i ] = 0.0;
-            }
+    // Start from the solution of coarser levels if requested
+    if ( this->Multilevel ) {
+        this->ComputeMultilevelGuess(Vertices, ConnectionStart, ConnectionIndex, OriginalPositions, CurrentPositions);
+        std :: copy( CurrentPositions.begin(), CurrentPositions.begin() + Vertices.size(), PreviousPositions.begin() );
+    }
+
+    // Solve the complete system at once if requested. Fall back to local sweeps if not possible.
+    bool solved = false;
+    if ( this->Global ) {
+        int globalitercount = this->SolveGlobal(Vertices, ConnectionStart, ConnectionIndex, OriginalPositions, CurrentPositions);
+        solved = ( globalitercount >= 0 );
+        totalitercount = totalitercount + std :: max(globalitercount, 0);
+        // If not converged, the sweeps start from the last Newton iterate
+        std :: copy( CurrentPositions.begin(), CurrentPositions.begin() + Vertices.size(), PreviousPositions.begin() );
+    }
 
-            //#pragma omp parallel default(shared)
-            {
+    // History for Anderson mixing
+    AndersonHistoryType AndersonHistory;
+    AndersonHistory.fNormPrevious = 0.0;
+
+    // Active set. Only vertices which moved, or are connected to a vertex which moved, more than ActiveTolerance in
+    // the previous sweep are updated. Convergence is always confirmed by a sweep over all vertices.
+    const double ActiveTolerance = charlength * 1e-4;
+    std :: vector< char >Active(Vertices.size(), 1);
+    std :: vector< char >Moved( Vertices.size() );
+    int activecount = Vertices.size();
+    bool fullsweep = true;
+
+    while ( !solved & ( itercount < MAX_ITER_COUNT ) & ( ( deltamax > ( charlength * 1e-3 ) ) | !fullsweep ) ) {
+        fullsweep = ( activecount == int( Vertices.size() ) );
+        deltamax = 0.0;
+        std :: fill(deltamaxnodes.begin(), deltamaxnodes.end(), 0);
+        std :: fill(deltamaxvalues.begin(), deltamaxvalues.end(), 0.0);
+
+        for ( size_t colour = 0; colour + 1 < ColourStart.size(); colour++ ) {
+            bool succeeded = ParallelFor(ColourStart [ colour ], ColourStart [ colour + 1 ], false, [ & ](int k) {
                 int threadid = 0;
 #ifdef OPENMP
                 threadid = omp_get_thread_num();
 #endif
+                int i = SweepOrder [ k ];
+                if ( !Active [ i ] ) {
+                    return;
+                }
 
-                //#pragma omp for schedule(static, 100)
-                for ( size_t i = 0; i < Vertices.size(); i++ ) {
-
-                    VertexType *v=Vertices[i];
-                    if (OriginalPositions.find(v)==OriginalPositions.end()) {
-                        LOG("Stuff\n",0);
-                    }
-
-                    std :: vector< std :: array< double, 3 > >ConnectionCoords;
-                    std :: vector< VertexType * >MyConnections = NewConnections.at(i);
-
-                    for ( VertexType *Connection: MyConnections ) {
-                        ConnectionCoords.push_back({ { PreviousPositions[Connection][ 0 ],
-                                                       PreviousPositions[Connection][ 1 ],
-                                                       PreviousPositions[Connection][ 2 ] } });
-                    }
-
-                    // Current vertex's position
-                    arma :: vec xc = {
-                        PreviousPositions[v] [ 0 ], PreviousPositions[v] [ 1 ], PreviousPositions[v] [ 2 ]
-                    };
-
-                    // Current vertex's original position
-                    arma :: vec x0 = {
-                        OriginalPositions[v] [ 0 ], OriginalPositions[v] [ 1 ], OriginalPositions[v] [ 2 ]
-                    };
-
-                    // Compute out-of-balance vector
-                    arma :: vec R = ComputeOutOfBalance(ConnectionCoords, xc, x0, alpha, Vertices.at(i)->c_constant);
-                    double err = arma :: norm(R);
-                    int iter = 0;
-
-                    // Find equilibrium
-                    while ( ( err > 1e-5 ) & ( iter < 100000 ) ) {
-                        arma :: mat T = ComputeAnalyticalTangent(ConnectionCoords, xc, x0, alpha, Vertices.at(i)->c_constant);
-                        arma :: vec delta = -arma :: solve(T, R);
-                        xc = xc + 1. * delta;
-                        R = ComputeOutOfBalance(ConnectionCoords, xc, x0, alpha, Vertices.at(i)->c_constant);
-                        err = arma :: norm(R);
-                        iter++;
-                    }
+                // Find equilibrium, starting from the current position
+                std :: array< double, 3 >xc = SweepPositions [ i ];
+                this->FindEquilibrium(SweepPositions, ConnectionIndex.data() + ConnectionStart [ i ], ConnectionStart [ i + 1 ] - ConnectionStart [ i ],
+                                      xc, OriginalPositions [ i ], Vertices [ i ]->c_constant);
 
-                    // If too many iterations, throw an exception and investigate...
-                    if ( iter > 99999 ) {
-                        throw( 0 );
-                    }
-
-                    // Update current position
-                    for ( int j = 0; j < 3; j++ ) {
-                        if ( !Vertices.at(i)->Fixed [ j ] ) {
-                            CurrentPositions[Vertices.at(i)] [ j ] = xc [ j ];
-                        }
-                    }
-
-                    // Update maximum delta
-                    arma :: vec d = {
-                        PreviousPositions[v] [ 0 ] - CurrentPositions[v] [ 0 ], PreviousPositions[v] [ 1 ] - CurrentPositions[v] [ 1 ], PreviousPositions[v] [ 2 ] - CurrentPositions[v] [ 2 ]
-                    };
-                    if ( arma :: norm(d) > deltamaxvalues [ threadid ] ) {
-                        deltamaxvalues [ threadid ] = arma :: norm(d);
-                        deltamaxnodes [ threadid ] = i;
+                // Update current position
+                for ( int j = 0; j < 3; j++ ) {
+                    if ( !Vertices [ i ]->Fixed [ j ] ) {
+                        CurrentPositions [ i ] [ j ] = xc [ j ];
                     }
-
                 }
 
-                // Update vertices
-                for ( VertexType *v: Vertices ) {
-                    for ( int j = 0; j < 3; j++ ) {
-                        v->set_c(CurrentPositions[v] [ j ], j);
-                    }
+                // Update maximum delta
+                double d = 0.0;
+                for ( int j = 0; j < 3; j++ ) {
+                    d = d + ( PreviousPositions [ i ] [ j ] - CurrentPositions [ i ] [ j ] ) * ( PreviousPositions [ i ] [ j ] - CurrentPositions [ i ] [ j ] );
                 }
-
-                // Update previous positions
-                for ( VertexType *v: Vertices ) {
-                    for ( int j = 0; j < 3; j++ ) {
-                        if ( !v->Fixed [ j ] ) {
-                            PreviousPositions[v] [ j ] = CurrentPositions[v] [ j ];
-                        }
-                    }
+                d = std :: sqrt(d);
+                if ( d > deltamaxvalues [ threadid ] ) {
+                    deltamaxvalues [ threadid ] = d;
+                    deltamaxnodes [ threadid ] = i;
                 }
-            }
+            });
 
-            deltamaxnode = 0;
-            for ( int i = 0; i < threadcount; i++ ) {
-                if ( deltamaxvalues [ i ] > deltamax ) {
-                    deltamax = deltamaxvalues [ i ];
-                    deltamaxnode = deltamaxnodes [ i ];
-                }
+            if ( !succeeded ) {
+                throw( 0 );
             }
+        }
 
-            STATUS("%c[2K\r\tIteration %u end with deltamax=%f at node %i\r", 27, itercount, deltamax, deltamaxnode);
-            fflush(stdout);
-
-            itercount++;
+        // Accelerate the sweeps by mixing in previous sweeps
+        if ( this->AndersonDepth > 0 ) {
+            this->AndersonMix(AndersonHistory, PreviousPositions, CurrentPositions, Vertices.size());
+        }
 
-#if EXPORT_SMOOTHING_ANIMATION == 1
-            // ************************** DEBUG STUFF
-            // Update vertices
-            for ( unsigned int i = 0; i < Vertices.size(); i++ ) {
-                VertexType *v = Vertices.at(i);
+        // Find the active set for the next sweep
+        if ( this->ActiveSet ) {
+#pragma omp parallel for
+            for ( int i = 0; i < int( Vertices.size() ); i++ ) {
+                Moved [ i ] = 0;
                 for ( int j = 0; j < 3; j++ ) {
-                    if ( !v->Fixed [ j ] ) {
-                        v->set_c(CurrentPositions[v] [ j ], j);
+                    if ( std :: fabs(CurrentPositions [ i ] [ j ] - PreviousPositions [ i ] [ j ]) > ActiveTolerance ) {
+                        Moved [ i ] = 1;
                     }
                 }
             }
-
-            if ( Mesh != NULL ) {
-                FileName.str("");
-                FileName.clear();
-                FileName << "/tmp/Smoothing" << itercount++ << ".vtp";
-                Mesh->ExportSurface(FileName.str(), FT_VTK);
+            activecount = 0;
+#pragma omp parallel for reduction(+:activecount)
+            for ( int i = 0; i < int( Vertices.size() ); i++ ) {
+                Active [ i ] = Moved [ i ];
+                for ( int k = ConnectionStart [ i ]; !Active [ i ] & ( k < ConnectionStart [ i + 1 ] ); k++ ) {
+                    int j = ConnectionIndex [ k ];
+                    Active [ i ] = ( j < int( Vertices.size() ) ) && Moved [ j ];
+                }
+                activecount = activecount + Active [ i ];
             }
-            // ************************** /DEBUG STUFF
-#endif
-
         }
 
-        // Check for intersecting triangles. If some triangles intersect, stiffen the structure in that area and re-smooth
-        std :: vector< std :: pair< TriangleType *, TriangleType * > >IntersectingTriangles = CheckPenetration(& Vertices, Mesh);
-        if ( IntersectingTriangles.size() > 0 ) {
-            // Pull back nodes until no intersecting triangles remain
-            intersecting_count = 0;
-            while ( IntersectingTriangles.size() > 0 ) {
-                STATUS("Stiffen and re-smooth surface/edge due to %u intersecting triangles, iteration %u\n", IntersectingTriangles.size(), intersecting_count);
-
-                // Stiffen spring
-                std :: vector< VertexType * >TriangleVertices;
-                for ( std :: pair< TriangleType *, TriangleType * >p : IntersectingTriangles ) {
-                    for ( VertexType *v : p.first->Vertices ) {
-                        TriangleVertices.push_back(v);
-                    }
-                    for ( VertexType *v : p.second->Vertices ) {
-                        TriangleVertices.push_back(v);
-                    }
-                }
+        // Update previous positions. Only positions of Vertices have changed, thus the others remain the same.
+        std :: copy( CurrentPositions.begin(), CurrentPositions.begin() + Vertices.size(), PreviousPositions.begin() );
 
-                std :: sort( TriangleVertices.begin(), TriangleVertices.end() );
-                TriangleVertices.erase( std :: unique( TriangleVertices.begin(), TriangleVertices.end() ), TriangleVertices.end() );
+        deltamaxnode = 0;
+        for ( int i = 0; i < threadcount; i++ ) {
+            if ( deltamaxvalues [ i ] > deltamax ) {
+                deltamax = deltamaxvalues [ i ];
+                deltamaxnode = deltamaxnodes [ i ];
+            }
+        }
 
-                for ( VertexType *v : TriangleVertices ) {
-                    arma :: vec displacement = {
-                        v->get_c(0) - v->originalcoordinates [ 0 ], v->get_c(1) - v->originalcoordinates [ 1 ], v->get_c(2) - v->originalcoordinates [ 2 ]
-                    };
-                    arma :: vec newdisplacement = displacement * .9;
+        // Confirm convergence over all vertices before stopping
+        if ( ( deltamax <= ( charlength * 1e-3 ) ) & !fullsweep ) {
+            std :: fill(Active.begin(), Active.end(), 1);
+            activecount = Vertices.size();
+        }
 
-                    for ( int i = 0; i < 3; i++ ) {
-                        v->set_c(v->originalcoordinates [ i ] + newdisplacement [ i ], i);
-                    }
-                }
+        STATUS("%c[2K\r\tIteration %u end with deltamax=%f at node %i, %i active vertices\r", 27, itercount, deltamax, deltamaxnode, activecount);
+        fflush(stdout);
 
-                IntersectingTriangles = CheckPenetration(& Vertices, Mesh);
-                intersecting_count++;
-            }
+        itercount++;
+        totalitercount++;
 
 #if EXPORT_SMOOTHING_ANIMATION == 1
-            std :: ostringstream FileName;
-            if ( Mesh != NULL ) {
-                FileName << "/tmp/Smoothing" << 0 << ".vtp";
-                Mesh->ExportSurface(FileName.str(), FT_VTK);
-            }
-#endif
-        } else {
-            intersecting = false;
-            // Update vertices
-            for ( VertexType *v: Vertices ) {
-                for ( int j = 0; j < 3; j++ ) {
-                    v->set_c(CurrentPositions[v] [ j ], j); // TODO: Use array to improve performance
-                }
-            }
+        // ************************** DEBUG STUFF
+        // Update vertices
+        UpdateVertices();
+
+        if ( Mesh != NULL ) {
+            FileName.str("");
+            FileName.clear();
+            FileName << "/tmp/Smoothing" << itercount++ << ".vtp";
+            Mesh->ExportSurface(FileName.str(), FT_VTK);
         }
-        STATUS("\n", 0);
+        // ************************** /DEBUG STUFF
+#endif
+
     }
 
+    // Converged. Update vertices and move vertices back if some triangles intersect.
+    this->UpdateAndRepair(Vertices, CurrentPositions, OriginalPositions, Mesh);
+    STATUS("\n", 0);
+
+    double time = std :: chrono :: duration< double >(std :: chrono :: steady_clock :: now() - starttime).count();
+    this->AddStatistics(Vertices, OriginalPositions, totalitercount, time);
+
 #if TEST_MESH_FOR_EACH_SMOOTHING
     TetGenCaller Tetgen;
     Tetgen.Mesh = Mesh;
@@ -4,7 +4,9 @@
 #include <vector>
 #include <math.h>
 #include <sstream>
-#include <armadillo>
+#include <unordered_map>
+#include <algorithm>
+#include <chrono>
 
 #include "MeshComponents.h"
 #include "MeshData.h"
@@ -29,7 +31,6 @@ class SmootherConfiguration
  */
 class SpringSmoother : public Smoother
 {
-    friend std::ostream &operator<<(std::ostream &stream, const SpringSmoother &Smoother);
 private:
 
     double c;
@@ -38,20 +39,140 @@ private:
     double charlength;
 
     double Compute_c(double l, double alpha);
-    arma :: vec ComputeOutOfBalance(std :: vector< std :: array< double, 3 > >ConnectionCoords, arma :: vec xc, arma :: vec x0, double alpha, double c);
-    arma :: mat ComputeNumericalTangent(std :: vector< std :: array< double, 3 > >ConnectionCoords, arma :: vec xc, arma :: vec x0, double alpha, double c);
-    arma :: mat ComputeAnalyticalTangent(std :: vector< std :: array< double, 3 > >ConnectionCoords, arma :: vec xc, arma :: vec x0, double alpha, double c);
-    arma :: mat ComputeAnalyticalTangentGlobal(std :: vector< std :: array< double, 3 > >ConnectionCoords, arma :: vec xc, arma :: vec x0, double alpha, double c);
+    // Out-of-balance force and its derivative for one vertex. The coordinates of the connected vertices are
+    // Positions[Connections[0]] to Positions[Connections[NumberOfConnections-1]]. The force from the original position
+    // is scaled by Weight.
+    void ComputeOutOfBalance(const std :: vector< std :: array< double, 3 > > &Positions, const int *Connections, int NumberOfConnections,
+                             const std :: array< double, 3 > &xc, const std :: array< double, 3 > &x0, double alpha, double c, std :: array< double, 3 > &R,
+                             double Weight = 1.0);
+    void ComputeAnalyticalTangent(const std :: array< double, 3 > &xc, const std :: array< double, 3 > &x0, int NumberOfConnections,
+                                  double alpha, double c, std :: array< std :: array< double, 3 >, 3 > &T, double Weight = 1.0);
 
-    void SpringSmoothGlobal(std :: vector< VertexType * >Vertices, std :: vector< bool >Fixed,
-                            std :: vector< std :: vector< VertexType * > >Connections,
-                            double c, double alpha, double charlength, bool Automatic_c = false,
-                            MeshData *Mesh = NULL);
+    /**
+     * @brief Finds the equilibrium position of one vertex with the connected vertices held at their positions. Uses
+     * Newton's method with a closed-form 3x3 solve. The step is halved until the out-of-balance norm decreases. If no
+     * step decreases it, or the iterations are exhausted, an exception is thrown.
+     * @param Positions Positions of vertices
+     * @param Connections Indices in Positions of connected vertices
+     * @param NumberOfConnections Number of connected vertices
+     * @param xc [in, out] Start guess and equilibrium position
+     * @param x0 Original position of the vertex
+     * @param c Spring constant of the vertex
+     * @param Force Additional constant force on the vertex, if any
+     * @param Weight Scale factor of the force from the original position
+     * @return Number of iterations
+     */
+    int FindEquilibrium(const std :: vector< std :: array< double, 3 > > &Positions, const int *Connections, int NumberOfConnections,
+                        std :: array< double, 3 > &xc, const std :: array< double, 3 > &x0, double c, const std :: array< double, 3 > *Force = NULL,
+                        double Weight = 1.0);
+
+    /**
+     * @brief Groups the vertices by colour such that no two vertices of the same colour are connected (greedy colouring).
+     * @param ConnectionStart Connections in compressed row format, see Smooth
+     * @param ConnectionIndex Connections in compressed row format, see Smooth
+     * @param SweepOrder [out] Vertex indices sorted by colour
+     * @param ColourStart [out] Vertices of colour k are SweepOrder[ColourStart[k]] to SweepOrder[ColourStart[k+1]-1]
+     */
+    void ColourVertices(const std :: vector< int > &ConnectionStart, const std :: vector< int > &ConnectionIndex,
+                        std :: vector< int > &SweepOrder, std :: vector< int > &ColourStart);
 
-    std :: vector< std :: pair< TriangleType *, TriangleType * > >CheckPenetration(std :: vector< VertexType * > *Vertices, MeshData *Mesh);
+    /**
+     * @brief Solves a sparse symmetric positive definite system using the conjugate gradient method with a Jacobi
+     * preconditioner. The matrix is stored in compressed row format.
+     * @param RowStart Start of each row in Columns and Values
+     * @param Columns Column of each value
+     * @param Values Matrix values
+     * @param b Right hand side
+     * @param x [out] Solution
+     * @param tol Tolerance relative to the norm of b
+     * @param maxiter Maximum number of iterations
+     * @return Number of iterations
+     */
+    int SolveCG(const std :: vector< int > &RowStart, const std :: vector< int > &Columns, const std :: vector< double > &Values,
+                const std :: vector< double > &b, std :: vector< double > &x, double tol, int maxiter);
+
+    /**
+     * @brief Finds the equilibrium of all vertices at once using Newton's method. Each Newton step is solved by
+     * preconditioned CG. The step is limited to the characteristic length and halved until the out-of-balance forces
+     * decrease.
+     * @param Vertices Vertices to smooth
+     * @param ConnectionStart Connections in compressed row format, see Smooth
+     * @param ConnectionIndex Connections in compressed row format, see Smooth
+     * @param OriginalPositions Original positions of all involved vertices
+     * @param Positions [in, out] Positions of all involved vertices
+     * @return Number of Newton iterations, -1 if the system cannot be solved this way, i.e. if the connections are not
+     * mutual, in which case Positions are unchanged, or -2 if Newton's method does not converge, in which case Positions
+     * hold the last iterate.
+     */
+    int SolveGlobal(std :: vector< VertexType * > &Vertices, const std :: vector< int > &ConnectionStart, const std :: vector< int > &ConnectionIndex,
+                     const std :: vector< std :: array< double, 3 > > &OriginalPositions, std :: vector< std :: array< double, 3 > > &Positions);
+
+    /**
+     * @brief Computes a start guess for smoothing from a hierarchy of coarser levels. Each level is built by aggregating
+     * the vertices of the finer level with their neighbours, each aggregate taking the mean position. The levels are
+     * smoothed from the coarsest and the displacements of the aggregates are added to the vertices of the next finer
+     * level. This moves large, flat regions in a few sweeps instead of one ring of neighbours per sweep.
+     * @param Vertices Vertices to smooth
+     * @param ConnectionStart Connections in compressed row format, see Smooth
+     * @param ConnectionIndex Connections in compressed row format, see Smooth
+     * @param OriginalPositions Original positions of all involved vertices
+     * @param Positions [in, out] Positions of all involved vertices
+     */
+    void ComputeMultilevelGuess(std :: vector< VertexType * > &Vertices, const std :: vector< int > &ConnectionStart, const std :: vector< int > &ConnectionIndex,
+                                const std :: vector< std :: array< double, 3 > > &OriginalPositions, std :: vector< std :: array< double, 3 > > &Positions);
+
+    // Previous sweeps used for Anderson mixing
+    struct AndersonHistoryType {
+        std :: vector< std :: vector< double > >dG;
+        std :: vector< std :: vector< double > >dF;
+        std :: vector< double >gPrevious;
+        std :: vector< double >fPrevious;
+        double fNormPrevious;
+    };
+
+    /**
+     * @brief Anderson mixing of sweeps. Given the positions x before and g after a sweep, g is replaced by the combination
+     * of the current and previous sweeps (at most AndersonDepth) with the smallest residual. The history is restarted,
+     * and g is left as is, if the residual increases or if the mixed positions are too far from g.
+     * @param History [in, out] Previous sweeps
+     * @param x Positions before the sweep
+     * @param g [in, out] Positions after the sweep
+     * @param n Number of vertices to mix, i.e. x[0] to x[n-1]
+     */
+    void AndersonMix(AndersonHistoryType &History, const std :: vector< std :: array< double, 3 > > &x,
+                     std :: vector< std :: array< double, 3 > > &g, int n);
+
+    void PrintParameters(std :: ostream &stream) const;
 
 public:
 
+    /**
+     * @brief If true, use Gauss-Seidel sweeps over groups of unconnected vertices instead of Jacobi sweeps. Gauss-Seidel
+     * usually converges in fewer sweeps. Both are run in parallel if compiled with OpenMP.
+     */
+    bool GaussSeidel;
+
+    /**
+     * @brief If true, solve for the equilibrium of all vertices at once by Newton's method instead of by sweeps of local
+     * updates. This usually converges in a few iterations for large, well connected surfaces.
+     */
+    bool Global;
+
+    /**
+     * @brief If true, start smoothing from the solution on coarser levels of aggregated vertices.
+     */
+    bool Multilevel;
+
+    /**
+     * @brief Number of previous sweeps used for Anderson mixing. Zero disables mixing.
+     */
+    int AndersonDepth;
+
+    /**
+     * @brief If true, only update vertices which moved, or are connected to vertices which moved, in the previous sweep.
+     */
+    bool ActiveSet;
+
     /**
      * @brief Constructor given data for the spring smoothing method
      * @param VoxelCharLength Charachteristic length of a voxel
@@ -0,0 +1,76 @@
+#include "TaubinSmoother.h"
+
+namespace voxel2tet
+{
+
+TaubinSmoother::TaubinSmoother(double lambda, double mu, int iterations) : Smoother ()
+{
+    this->lambda = lambda;
+    this->mu = mu;
+    this->iterations = iterations;
+
+    if ( ( lambda <= 0.0 ) | ( mu >= -lambda ) ) {
+        STATUS("Taubin smoothing requires mu < -lambda < 0, got lambda=%f, mu=%f\n", lambda, mu);
+        throw( 0 );
+    }
+}
+
+void TaubinSmoother::PrintParameters(std :: ostream &stream) const
+{
+    stream << "\tTaubin smoother\n";
+    stream << "\tlambda = " << this->lambda << ", mu = " << this->mu << ", iterations = " << this->iterations << "\n";
+}
+
+void TaubinSmoother::Smooth(std :: vector< VertexType * >Vertices, MeshData *Mesh)
+{
+    std :: chrono :: steady_clock :: time_point starttime = std :: chrono :: steady_clock :: now();
+
+    std :: vector< VertexType * >LocalVertices;
+    std :: vector< int >ConnectionStart;
+    std :: vector< int >ConnectionIndex;
+    this->GetConnectivity(Vertices, LocalVertices, ConnectionStart, ConnectionIndex);
+
+    std :: vector< std :: array< double, 3 > >OriginalPositions( LocalVertices.size() );
+    for ( size_t i = 0; i < LocalVertices.size(); i++ ) {
+        OriginalPositions [ i ] = LocalVertices [ i ]->get_c();
+    }
+    std :: vector< std :: array< double, 3 > >CurrentPositions = OriginalPositions;
+    std :: vector< std :: array< double, 3 > >PreviousPositions = OriginalPositions;
+
+    // Moves each vertex a factor of the distance to the mean of its connected vertices. Only positions of Vertices
+    // change, thus the others remain the same.
+    int n = Vertices.size();
+    auto Step = [ & ](double factor) {
+                    std :: copy( CurrentPositions.begin(), CurrentPositions.begin() + n, PreviousPositions.begin() );
+#pragma omp parallel for
+                    for ( int i = 0; i < n; i++ ) {
+                        int NumberOfConnections = ConnectionStart [ i + 1 ] - ConnectionStart [ i ];
+                        if ( NumberOfConnections == 0 ) {
+                            continue;
+                        }
+                        std :: array< double, 3 >Mean = { { 0.0, 0.0, 0.0 } };
+                        for ( int k = ConnectionStart [ i ]; k < ConnectionStart [ i + 1 ]; k++ ) {
+                            for ( int j = 0; j < 3; j++ ) {
+                                Mean [ j ] = Mean [ j ] + PreviousPositions [ ConnectionIndex [ k ] ] [ j ];
+                            }
+                        }
+                        for ( int j = 0; j < 3; j++ ) {
+                            if ( !Vertices [ i ]->Fixed [ j ] ) {
+                                CurrentPositions [ i ] [ j ] = PreviousPositions [ i ] [ j ] + factor * ( Mean [ j ] / NumberOfConnections - PreviousPositions [ i ] [ j ] );
+                            }
+                        }
+                    }
+                };
+
+    for ( int iter = 0; iter < this->iterations; iter++ ) {
+        Step(this->lambda);
+        Step(this->mu);
+    }
+
+    this->UpdateAndRepair(Vertices, CurrentPositions, OriginalPositions, Mesh);
+
+    double time = std :: chrono :: duration< double >(std :: chrono :: steady_clock :: now() - starttime).count();
+    this->AddStatistics(Vertices, OriginalPositions, this->iterations, time);
+}
+
+}
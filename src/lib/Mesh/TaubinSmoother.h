@@ -0,0 +1,46 @@
+#ifndef TAUBINSMOOTHER_H
+#define TAUBINSMOOTHER_H
+
+#include <vector>
+#include <array>
+#include <chrono>
+
+#include "MeshComponents.h"
+#include "MeshData.h"
+#include "Smoother.h"
+
+namespace voxel2tet
+{
+
+/**
+ * @brief Provides lambda/mu smoothing as suggested by Taubin.
+ *
+ * Each iteration consists of two Laplacian steps. The first step moves each vertex a factor lambda towards the mean of
+ * its connected vertices and the second step moves it a factor mu, where mu < -lambda < 0, i.e. away from the mean. The
+ * second step undoes the shrinkage caused by the first, thus the volume is approximately preserved. This is much
+ * cheaper than spring smoothing but does not limit how far a vertex moves from its original position.
+ */
+class TaubinSmoother : public Smoother
+{
+private:
+    double lambda;
+    double mu;
+    int iterations;
+
+    void PrintParameters(std :: ostream &stream) const;
+
+public:
+    /**
+     * @brief Constructor
+     * @param lambda Positive scale factor of the shrinking step
+     * @param mu Negative scale factor of the inflating step. Should be smaller than -lambda.
+     * @param iterations Number of pairs of steps
+     */
+    TaubinSmoother(double lambda, double mu, int iterations);
+    ~TaubinSmoother() {}
+
+    void Smooth(std :: vector< VertexType * >Vertices, MeshData *Mesh = NULL);
+};
+
+}
+#endif
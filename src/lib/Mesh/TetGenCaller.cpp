@@ -5,32 +5,10 @@ namespace voxel2tet
 TetGenCaller :: TetGenCaller()
 {}
 
-void TetGenCaller :: UpdateVertexMapping()
-{
-    this->VertexMapFromID.clear();
-    this->VertexMapFromTetgen.clear();
-
-    std :: vector< VertexType * >VertexIDsFromTriangles;
-
-    for ( TriangleType *t : this->Mesh->Triangles ) {
-        for ( VertexType *v : t->Vertices ) {
-            VertexIDsFromTriangles.push_back(v);
-        }
-    }
-
-    std :: sort( VertexIDsFromTriangles.begin(), VertexIDsFromTriangles.end() );
-
-    VertexIDsFromTriangles.erase( std :: unique( VertexIDsFromTriangles.begin(), VertexIDsFromTriangles.end() ), VertexIDsFromTriangles.end() );
-
-    for ( unsigned int i = 0; i < VertexIDsFromTriangles.size(); i++ ) {
-        this->VertexMapFromID [ VertexIDsFromTriangles.at(i) ] = i;
-        this->VertexMapFromTetgen [ i ] = VertexIDsFromTriangles.at(i);
-    }
-}
-
 void TetGenCaller :: CopyMeshFromSelf(tetgenio *in)
 {
-    this->UpdateVertexMapping();
+    // The snapshot supplies the condensed numbering, i.e. where all vertices not used by any triangle are removed
+    MeshSnapshot *Snapshot = this->Mesh->CreateSnapshot();
     tetgenio :: facet *f;
     tetgenio :: polygon *p;
 
@@ -38,27 +16,24 @@ void TetGenCaller :: CopyMeshFromSelf(tetgenio *in)
     in->firstnumber = 0;
 
     // Copy mesh vertices
-    in->numberofpoints = this->VertexMapFromID.size();
+    in->numberofpoints = Snapshot->SurfaceVertices.size();
     in->pointlist = new REAL [ in->numberofpoints * 3 ];
 
     unsigned int cid = 0; // Coordinate id. (0, 1, 2), (3, 4, 5), (6, 7, 8) ...
 
-    std :: map< VertexType *, int > :: iterator iter;
-    for ( iter = this->VertexMapFromID.begin(); iter != this->VertexMapFromID.end(); iter++ ) {
-        VertexType *v = iter->first;
-        for ( double coordvalue : v->get_c() ) {
-            in->pointlist [ cid ] = coordvalue;
+    for ( int v : Snapshot->SurfaceVertices ) {
+        for ( int j = 0; j < 3; j++ ) {
+            in->pointlist [ cid ] = Snapshot->GiveCoordinate(v, j);
             cid++;
         }
     }
 
     // Copy mesh triangles
-    in->numberoffacets = this->Mesh->Triangles.size();
+    in->numberoffacets = Snapshot->GiveNumberOfTriangles();
     in->facetlist = new tetgenio :: facet [ in->numberoffacets ]; // List of triangles
     in->facetmarkerlist = new int [ in->numberoffacets ]; // List of tag for each triangle
 
-    unsigned int tid = 0;
-    for ( TriangleType *t : this->Mesh->Triangles ) {
+    for ( int tid = 0; tid < in->numberoffacets; tid++ ) {
         f = & in->facetlist [ tid ];
 
         f->numberofpolygons = 1;
@@ -71,27 +46,22 @@ void TetGenCaller :: CopyMeshFromSelf(tetgenio *in)
         p->vertexlist = new int [ p->numberofvertices ];
 
         for ( int i = 0; i < 3; i++ ) {
-            VertexType *v = t->Vertices.at(i);
-            int TetGenID = this->VertexMapFromID [ v ];
-            p->vertexlist [ i ] = TetGenID;
+            p->vertexlist [ i ] = Snapshot->SurfaceVertexIndex [ Snapshot->TriangleVertices [ 3 * tid + i ] ];
         }
 
-        in->facetmarkerlist [ tid ] = t->InterfaceID;
-
-        tid++;
+        in->facetmarkerlist [ tid ] = Snapshot->InterfaceIDs [ tid ];
     }
+
+    delete Snapshot;
 }
 
 MeshData *TetGenCaller :: CopyTetMesh(tetgenio *io)
 {
     MeshData *NewMesh = new MeshData(this->Mesh->BoundingBox);
+    NewMesh->VertexGrid->SetCellSize( this->Mesh->VertexGrid->GiveCellSize() );
 
-    // Add vertices
-    for ( int i = 0; i < io->numberofpoints; i++ ) {
-        double *c;
-        c = & io->pointlist [ 3 * i ];
-        NewMesh->VertexOctreeRoot->AddVertex(c [ 0 ], c [ 1 ], c [ 2 ]);
-    }
+    // Add vertices. TetGen gives unique points, thus no need to search for existing vertices.
+    NewMesh->VertexGrid->AddVertices(io->pointlist, io->numberofpoints, true);
 
     // Add triangles
     for ( int i = 0; i < io->numberoftrifaces; i++ ) {
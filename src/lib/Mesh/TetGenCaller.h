@@ -7,6 +7,7 @@
 #define TETLIBRARY = 1
 #include "tetgen.h"
 #include "MeshGenerator3D.h"
+#include "MeshSnapshot.h"
 
 namespace voxel2tet
 {
@@ -16,11 +17,6 @@ namespace voxel2tet
 class TetGenCaller : public MeshGenerator3D
 {
 private:
-    // Mapping for vertices. Key is Vertex.ID and value is the condensed ID (i.e. the ID where all unused vertices are removed)
-    std :: map< VertexType *, int >VertexMapFromID;
-    std :: map< int, VertexType * >VertexMapFromTetgen;
-    void UpdateVertexMapping();
-
     void CopyMeshFromSelf(tetgenio *io);
     MeshData *CopyTetMesh(tetgenio *io);
 
@@ -0,0 +1,336 @@
+#include <algorithm>
+
+#include "TriangleAABBTree.h"
+
+namespace voxel2tet
+{
+// Surface area of box, used as cost when choosing where to insert new leaves
+static double GiveBoxArea(const std :: array< double, 3 > &min, const std :: array< double, 3 > &max)
+{
+    double dx = max [ 0 ] - min [ 0 ], dy = max [ 1 ] - min [ 1 ], dz = max [ 2 ] - min [ 2 ];
+    return 2.0 * ( dx * dy + dy * dz + dz * dx );
+}
+
+static double GiveUnionArea(const std :: array< double, 3 > &min1, const std :: array< double, 3 > &max1, const std :: array< double, 3 > &min2, const std :: array< double, 3 > &max2)
+{
+    std :: array< double, 3 >min, max;
+    for ( int i = 0; i < 3; i++ ) {
+        min [ i ] = std :: min(min1 [ i ], min2 [ i ]);
+        max [ i ] = std :: max(max1 [ i ], max2 [ i ]);
+    }
+    return GiveBoxArea(min, max);
+}
+
+TriangleAABBTree :: TriangleAABBTree()
+{
+    this->root = -1;
+}
+
+void TriangleAABBTree :: Clear()
+{
+    this->Nodes.clear();
+    this->FreeNodes.clear();
+    this->Leaves.clear();
+    this->root = -1;
+}
+
+int TriangleAABBTree :: AllocateNode()
+{
+    int Node;
+    if ( this->FreeNodes.empty() ) {
+        Node = this->Nodes.size();
+        this->Nodes.push_back( NodeType() );
+    } else {
+        Node = this->FreeNodes.back();
+        this->FreeNodes.pop_back();
+    }
+    this->Nodes [ Node ].parent = -1;
+    this->Nodes [ Node ].left = -1;
+    this->Nodes [ Node ].right = -1;
+    this->Nodes [ Node ].Triangle = NULL;
+    return Node;
+}
+
+void TriangleAABBTree :: FreeNode(int Node)
+{
+    this->FreeNodes.push_back(Node);
+}
+
+void TriangleAABBTree :: UpdateLeafBox(int Node)
+{
+    NodeType &n = this->Nodes [ Node ];
+    for ( int i = 0; i < 3; i++ ) {
+        n.min [ i ] = n.max [ i ] = n.Triangle->Vertices [ 0 ]->get_c(i);
+        for ( int j = 1; j < 3; j++ ) {
+            double c = n.Triangle->Vertices [ j ]->get_c(i);
+            n.min [ i ] = std :: min(n.min [ i ], c);
+            n.max [ i ] = std :: max(n.max [ i ], c);
+        }
+    }
+}
+
+void TriangleAABBTree :: UpdateInternalBox(int Node)
+{
+    NodeType &n = this->Nodes [ Node ];
+    const NodeType &l = this->Nodes [ n.left ];
+    const NodeType &r = this->Nodes [ n.right ];
+    for ( int i = 0; i < 3; i++ ) {
+        n.min [ i ] = std :: min(l.min [ i ], r.min [ i ]);
+        n.max [ i ] = std :: max(l.max [ i ], r.max [ i ]);
+    }
+}
+
+void TriangleAABBTree :: RefitAncestors(int Node)
+{
+    int Current = this->Nodes [ Node ].parent;
+    while ( Current != -1 ) {
+        this->UpdateInternalBox(Current);
+        Current = this->Nodes [ Current ].parent;
+    }
+}
+
+int TriangleAABBTree :: BuildRange(std :: vector< int > &Items, std :: vector< std :: array< double, 3 > > &Centers, size_t begin, size_t end)
+{
+    if ( end - begin == 1 ) {
+        return Items [ begin ];
+    }
+
+    // Split at the median along the longest side of the box containing the centers
+    std :: array< double, 3 >min = Centers [ Items [ begin ] ], max = Centers [ Items [ begin ] ];
+    for ( size_t i = begin; i < end; i++ ) {
+        for ( int j = 0; j < 3; j++ ) {
+            min [ j ] = std :: min(min [ j ], Centers [ Items [ i ] ] [ j ]);
+            max [ j ] = std :: max(max [ j ], Centers [ Items [ i ] ] [ j ]);
+        }
+    }
+
+    int Axis = 0;
+    for ( int j = 1; j < 3; j++ ) {
+        if ( max [ j ] - min [ j ] > max [ Axis ] - min [ Axis ] ) {
+            Axis = j;
+        }
+    }
+
+    size_t mid = begin + ( end - begin ) / 2;
+    std :: nth_element(Items.begin() + begin, Items.begin() + mid, Items.begin() + end, [ & ](int a, int b) {
+                           return Centers [ a ] [ Axis ] < Centers [ b ] [ Axis ];
+                       });
+
+    int left = this->BuildRange(Items, Centers, begin, mid);
+    int right = this->BuildRange(Items, Centers, mid, end);
+
+    int Node = this->AllocateNode();
+    this->Nodes [ Node ].left = left;
+    this->Nodes [ Node ].right = right;
+    this->Nodes [ left ].parent = Node;
+    this->Nodes [ right ].parent = Node;
+    this->UpdateInternalBox(Node);
+    return Node;
+}
+
+void TriangleAABBTree :: Build(std :: vector< TriangleType * > &Triangles)
+{
+    this->Clear();
+    if ( Triangles.empty() ) {
+        return;
+    }
+
+    this->Nodes.reserve(2 * Triangles.size() - 1);
+    this->Leaves.reserve( Triangles.size() );
+
+    // Leaves are stored first, with the node index equal to the triangle index
+    std :: vector< int >Items( Triangles.size() );
+    std :: vector< std :: array< double, 3 > >Centers( Triangles.size() );
+    for ( size_t i = 0; i < Triangles.size(); i++ ) {
+        int Leaf = this->AllocateNode();
+        this->Nodes [ Leaf ].Triangle = Triangles [ i ];
+        this->UpdateLeafBox(Leaf);
+        this->Leaves [ Triangles [ i ] ] = Leaf;
+        Items [ i ] = Leaf;
+        Centers [ i ] = Triangles [ i ]->GiveCenterOfMass();
+    }
+
+    this->root = this->BuildRange(Items, Centers, 0, Items.size());
+}
+
+void TriangleAABBTree :: InsertLeaf(int Leaf)
+{
+    if ( this->root == -1 ) {
+        this->root = Leaf;
+        this->Nodes [ Leaf ].parent = -1;
+        return;
+    }
+
+    // Find the best sibling by descending towards the child that increases the surface area the least
+    const std :: array< double, 3 >LeafMin = this->Nodes [ Leaf ].min;
+    const std :: array< double, 3 >LeafMax = this->Nodes [ Leaf ].max;
+    int Sibling = this->root;
+    while ( !this->IsLeaf(Sibling) ) {
+        const NodeType &n = this->Nodes [ Sibling ];
+        double Area = GiveBoxArea(n.min, n.max);
+        double CombinedArea = GiveUnionArea(n.min, n.max, LeafMin, LeafMax);
+
+        // Cost of making a new parent for this node and the new leaf
+        double Cost = 2.0 * CombinedArea;
+
+        // Minimum cost of pushing the leaf further down
+        double InheritanceCost = 2.0 * ( CombinedArea - Area );
+
+        std :: array< double, 2 >ChildCost;
+        std :: array< int, 2 >Children = { { n.left, n.right } };
+        for ( int i = 0; i < 2; i++ ) {
+            const NodeType &c = this->Nodes [ Children [ i ] ];
+            ChildCost [ i ] = GiveUnionArea(c.min, c.max, LeafMin, LeafMax) + InheritanceCost;
+            if ( !this->IsLeaf(Children [ i ]) ) {
+                ChildCost [ i ] = ChildCost [ i ] - GiveBoxArea(c.min, c.max);
+            }
+        }
+
+        if ( ( Cost < ChildCost [ 0 ] ) && ( Cost < ChildCost [ 1 ] ) ) {
+            break;
+        }
+
+        Sibling = ( ChildCost [ 0 ] < ChildCost [ 1 ] ) ? Children [ 0 ] : Children [ 1 ];
+    }
+
+    // Create a new parent for the sibling and the leaf
+    int OldParent = this->Nodes [ Sibling ].parent;
+    int NewParent = this->AllocateNode();
+    this->Nodes [ NewParent ].parent = OldParent;
+    this->Nodes [ NewParent ].left = Sibling;
+    this->Nodes [ NewParent ].right = Leaf;
+    this->Nodes [ Sibling ].parent = NewParent;
+    this->Nodes [ Leaf ].parent = NewParent;
+
+    if ( OldParent == -1 ) {
+        this->root = NewParent;
+    } else if ( this->Nodes [ OldParent ].left == Sibling ) {
+        this->Nodes [ OldParent ].left = NewParent;
+    } else {
+        this->Nodes [ OldParent ].right = NewParent;
+    }
+
+    this->UpdateInternalBox(NewParent);
+    this->RefitAncestors(NewParent);
+}
+
+void TriangleAABBTree :: Insert(TriangleType *Triangle)
+{
+    if ( this->Leaves.find(Triangle) != this->Leaves.end() ) {
+        return;
+    }
+
+    int Leaf = this->AllocateNode();
+    this->Nodes [ Leaf ].Triangle = Triangle;
+    this->UpdateLeafBox(Leaf);
+    this->Leaves [ Triangle ] = Leaf;
+    this->InsertLeaf(Leaf);
+}
+
+void TriangleAABBTree :: Remove(TriangleType *Triangle)
+{
+    auto it = this->Leaves.find(Triangle);
+    if ( it == this->Leaves.end() ) {
+        return;
+    }
+    int Leaf = it->second;
+    this->Leaves.erase(it);
+
+    int Parent = this->Nodes [ Leaf ].parent;
+    this->FreeNode(Leaf);
+
+    if ( Parent == -1 ) {
+        this->root = -1;
+        return;
+    }
+
+    // Replace the parent by the sibling
+    int GrandParent = this->Nodes [ Parent ].parent;
+    int Sibling = ( this->Nodes [ Parent ].left == Leaf ) ? this->Nodes [ Parent ].right : this->Nodes [ Parent ].left;
+    this->Nodes [ Sibling ].parent = GrandParent;
+    this->FreeNode(Parent);
+
+    if ( GrandParent == -1 ) {
+        this->root = Sibling;
+    } else {
+        if ( this->Nodes [ GrandParent ].left == Parent ) {
+            this->Nodes [ GrandParent ].left = Sibling;
+        } else {
+            this->Nodes [ GrandParent ].right = Sibling;
+        }
+        this->UpdateInternalBox(GrandParent);
+        this->RefitAncestors(GrandParent);
+    }
+}
+
+void TriangleAABBTree :: Refit(TriangleType *Triangle)
+{
+    auto it = this->Leaves.find(Triangle);
+    if ( it == this->Leaves.end() ) {
+        return;
+    }
+    this->UpdateLeafBox(it->second);
+    this->RefitAncestors(it->second);
+}
+
+void TriangleAABBTree :: RefitAll()
+{
+    if ( this->root == -1 ) {
+        return;
+    }
+
+    // Children are always located after their parents in pre-order, thus traverse pre-order backwards
+    std :: vector< int >Order;
+    Order.reserve( this->Nodes.size() );
+    std :: vector< int >Stack = { this->root };
+    while ( !Stack.empty() ) {
+        int Node = Stack.back();
+        Stack.pop_back();
+        Order.push_back(Node);
+        if ( !this->IsLeaf(Node) ) {
+            Stack.push_back(this->Nodes [ Node ].left);
+            Stack.push_back(this->Nodes [ Node ].right);
+        }
+    }
+
+    for ( auto it = Order.rbegin(); it != Order.rend(); it++ ) {
+        if ( this->IsLeaf(* it) ) {
+            this->UpdateLeafBox(* it);
+        } else {
+            this->UpdateInternalBox(* it);
+        }
+    }
+}
+
+void TriangleAABBTree :: Query(const std :: array< double, 3 > &min, const std :: array< double, 3 > &max, std :: vector< TriangleType * > &Result) const
+{
+    std :: vector< int >Stack;
+    this->Query(min, max, Result, Stack);
+}
+
+void TriangleAABBTree :: Query(const std :: array< double, 3 > &min, const std :: array< double, 3 > &max, std :: vector< TriangleType * > &Result, std :: vector< int > &Stack) const
+{
+    Stack.clear();
+    if ( this->root == -1 ) {
+        return;
+    }
+
+    Stack.push_back(this->root);
+    while ( !Stack.empty() ) {
+        const NodeType &n = this->Nodes [ Stack.back() ];
+        Stack.pop_back();
+
+        if ( ( n.min [ 0 ] > max [ 0 ] ) | ( n.min [ 1 ] > max [ 1 ] ) | ( n.min [ 2 ] > max [ 2 ] ) |
+             ( n.max [ 0 ] < min [ 0 ] ) | ( n.max [ 1 ] < min [ 1 ] ) | ( n.max [ 2 ] < min [ 2 ] ) ) {
+            continue;
+        }
+
+        if ( n.left == -1 ) {
+            Result.push_back(n.Triangle);
+        } else {
+            Stack.push_back(n.left);
+            Stack.push_back(n.right);
+        }
+    }
+}
+}
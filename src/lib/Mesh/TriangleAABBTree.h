@@ -0,0 +1,135 @@
+#ifndef TRIANGLEAABBTREE_H
+#define TRIANGLEAABBTREE_H
+
+#include <vector>
+#include <array>
+#include <unordered_map>
+
+#include "MeshComponents.h"
+
+namespace voxel2tet
+{
+
+/**
+ * @brief Dynamic bounding volume hierarchy of axis aligned bounding boxes (AABB) over triangles.
+ *
+ * Each leaf holds one triangle and each internal node holds the union of the boxes of its two children. The tree is
+ * used to find all triangles whose bounding boxes overlap a given box, e.g. the box of a candidate triangle in a
+ * penetration check. The cost of such a query depends on the size of the box and not on the longest edge of the mesh.
+ *
+ * The tree is either bulk built from a list of triangles or grown by inserting triangles one by one. When a vertex is
+ * moved, the boxes of its triangles must be refitted. When the topology changes, triangles are inserted and removed.
+ *
+ * Concurrency: Query may be called from several threads at the same time, given that no thread modifies the tree in the
+ * meanwhile. Each thread should then use its own result list and stack.
+ */
+class TriangleAABBTree
+{
+private:
+    struct NodeType {
+        std :: array< double, 3 >min;
+        std :: array< double, 3 >max;
+        int parent;
+        int left;
+        int right;
+        TriangleType *Triangle;
+    };
+
+    std :: vector< NodeType >Nodes;
+    int root;
+
+    // Indices of unused elements in Nodes
+    std :: vector< int >FreeNodes;
+
+    // Leaf node of each triangle in the tree
+    std :: unordered_map< TriangleType *, int >Leaves;
+
+    int AllocateNode();
+    void FreeNode(int Node);
+
+    bool IsLeaf(int Node) const { return this->Nodes [ Node ].left == -1; }
+
+    // Sets the box of a leaf to the box of its triangle
+    void UpdateLeafBox(int Node);
+
+    // Sets the box of an internal node to the union of its children
+    void UpdateInternalBox(int Node);
+
+    // Updates the boxes of all ancestors of a node
+    void RefitAncestors(int Node);
+
+    // Inserts a leaf node into the tree
+    void InsertLeaf(int Leaf);
+
+    // Builds a subtree from the leaves in Items[begin, end). Returns the root of the subtree.
+    int BuildRange(std :: vector< int > &Items, std :: vector< std :: array< double, 3 > > &Centers, size_t begin, size_t end);
+
+public:
+    /**
+     * @brief Constructor. Creates an empty tree.
+     */
+    TriangleAABBTree();
+
+    /**
+     * @brief Removes all triangles from the tree
+     */
+    void Clear();
+
+    /**
+     * @brief Builds the tree from a list of triangles. Any previous content is removed.
+     *
+     * The triangles are split recursively at the median of the centers of mass along the longest side of the box.
+     *
+     * @param Triangles List of triangles
+     */
+    void Build(std :: vector< TriangleType * > &Triangles);
+
+    /**
+     * @brief Inserts a triangle into the tree
+     * @param Triangle Pointer to triangle
+     */
+    void Insert(TriangleType *Triangle);
+
+    /**
+     * @brief Removes a triangle from the tree. Nothing happens if the triangle is not in the tree.
+     * @param Triangle Pointer to triangle
+     */
+    void Remove(TriangleType *Triangle);
+
+    /**
+     * @brief Updates the box of a triangle, and its ancestors, after any of its vertices has moved
+     * @param Triangle Pointer to triangle
+     */
+    void Refit(TriangleType *Triangle);
+
+    /**
+     * @brief Updates the boxes of all triangles. Use this after many vertices have moved.
+     */
+    void RefitAll();
+
+    /**
+     * @brief Finds all triangles with bounding boxes overlapping a box
+     * @param min Minimum corner of box
+     * @param max Maximum corner of box
+     * @param Result [out] Triangles found are appended to this list
+     */
+    void Query(const std :: array< double, 3 > &min, const std :: array< double, 3 > &max, std :: vector< TriangleType * > &Result) const;
+
+    /**
+     * @brief Finds all triangles with bounding boxes overlapping a box using a caller-provided stack. The stack is
+     * cleared before use, but its capacity is kept, thus the query does not allocate memory when the stack is reused.
+     * @param min Minimum corner of box
+     * @param max Maximum corner of box
+     * @param Result [out] Triangles found are appended to this list
+     * @param Stack [in, out] Scratch storage for nodes to visit
+     */
+    void Query(const std :: array< double, 3 > &min, const std :: array< double, 3 > &max, std :: vector< TriangleType * > &Result, std :: vector< int > &Stack) const;
+
+    /**
+     * @brief Number of triangles in the tree
+     */
+    size_t size() const { return this->Leaves.size(); }
+};
+}
+
+#endif // TRIANGLEAABBTREE_H
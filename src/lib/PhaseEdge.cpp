@@ -2,7 +2,7 @@
 
 namespace voxel2tet
 {
-PhaseEdge :: PhaseEdge(Options *Opt, SpringSmoother *EdgeSmoother)
+PhaseEdge :: PhaseEdge(Options *Opt, Smoother *EdgeSmoother)
 {
     this->Opt = Opt;
     this->EdgeSmoother = EdgeSmoother;
@@ -202,6 +202,23 @@ void PhaseEdge :: AddPhaseEdgeSegment(VertexType *v1, VertexType *v2)
     EdgeSegments.push_back({ { v1, v2 } });
 }
 
+void PhaseEdge :: RemoveVertex(VertexType *v)
+{
+    // The segments are ordered, i.e. the segment ending in v is followed by the segment starting in v. For closed edges,
+    // the last segment is followed by the first.
+    for ( size_t i = 0; i < this->EdgeSegments.size(); i++ ) {
+        if ( this->EdgeSegments [ i ] [ 1 ] == v ) {
+            size_t Next = ( i + 1 ) % this->EdgeSegments.size();
+            if ( ( Next == i ) || ( this->EdgeSegments [ Next ] [ 0 ] != v ) ) {
+                return;
+            }
+            this->EdgeSegments [ i ] [ 1 ] = this->EdgeSegments [ Next ] [ 1 ];
+            this->EdgeSegments.erase(this->EdgeSegments.begin() + Next);
+            return;
+        }
+    }
+}
+
 void PhaseEdge :: LogPhaseEdge()
 {
 #if LOGOUTPUT == 1
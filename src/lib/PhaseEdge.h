@@ -6,7 +6,7 @@
 #include <MeshComponents.h>
 #include <MiscFunctions.h>
 
-#include "SpringSmoother.h"
+#include "Smoother.h"
 #include "Options.h"
 #include "MeshData.h"
 
@@ -48,14 +48,14 @@ public:
     /**
      * @brief Pointer to smoother object for this phase edge.
      */
-    SpringSmoother *EdgeSmoother;
+    Smoother *EdgeSmoother;
 
     /**
      * @brief Constructor
      * @param Opt Input. An Options object for communicating the command line parameters.
      * @param EdgeSmoother Input. Smoother object to the phase edge.
      */
-    PhaseEdge(Options *Opt, SpringSmoother *EdgeSmoother);
+    PhaseEdge(Options *Opt, Smoother *EdgeSmoother);
 
     /**
      * @brief SortAndFixBrokenEdge Identifies all separate phase edges within this PhaseEdge object and outputs all (new) internally connected phase edges.
@@ -94,6 +94,13 @@ public:
      */
     void AddPhaseEdgeSegment(VertexType *v1, VertexType *v2);
 
+    /**
+     * @brief Replaces the two edge segments meeting at vertex \p v by one segment between their other vertices. Used
+     * when \p v has been removed from the mesh by collapsing one of the segments. End vertices are not removed.
+     * @param v Input. Vertex to remove.
+     */
+    void RemoveVertex(VertexType *v);
+
     /**
      * @brief Determines if the PhaseEdge is closed or not, i.e. if it has ends
      * @return Wither the curve is closed or not.
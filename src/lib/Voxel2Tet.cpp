@@ -15,6 +15,9 @@
 #include "CallbackImporter.h"
 #include "TetGenCaller.h"
 #include "SpringSmoother.h"
+#include "TaubinSmoother.h"
+#include "LaplacianSmoother.h"
+#include "SignedDistanceSmoother.h"
 
 namespace voxel2tet
 {
@@ -30,6 +33,23 @@ Voxel2TetClass :: Voxel2TetClass(Options *Opt)
 
     this->Opt->AddDefaultMap("edge_spring_c_factor", ".75");
     this->Opt->AddDefaultMap("edge_spring_alpha", "3");
+    this->Opt->AddDefaultMap("spring_gaussseidel", "0");
+    this->Opt->AddDefaultMap("spring_global", "0");
+    this->Opt->AddDefaultMap("spring_multilevel", "0");
+    this->Opt->AddDefaultMap("spring_anderson", "0");
+    this->Opt->AddDefaultMap("spring_activeset", "0");
+    this->Opt->AddDefaultMap("smoother", "spring");
+    this->Opt->AddDefaultMap("edge_smoother", "spring");
+    this->Opt->AddDefaultMap("taubin_lambda", ".5");
+    this->Opt->AddDefaultMap("taubin_mu", "-.53");
+    this->Opt->AddDefaultMap("taubin_iterations", "10");
+    this->Opt->AddDefaultMap("laplacian_limit_factor", ".5");
+    this->Opt->AddDefaultMap("laplacian_maxiter", "1000");
+    this->Opt->AddDefaultMap("sdf_sigma", ".75");
+    this->Opt->AddDefaultMap("sdf_passes", "3");
+    this->Opt->AddDefaultMap("edge_parallel", "0");
+    this->Opt->AddDefaultMap("edge_simplify", "0");
+    this->Opt->AddDefaultMap("edge_simplify_tolerance", ".5");
 
     // Dream3D options
     this->Opt->AddDefaultMap("DataContainer", "VoxelDataContainer");
@@ -43,6 +63,12 @@ Voxel2TetClass :: Voxel2TetClass(Options *Opt)
     this->Opt->AddDefaultMap("exportabaqus", "0");
     this->Opt->AddDefaultMap("exportsteps", "0");
 
+    // Memory usage
+    this->Opt->AddDefaultMap("releasevoxeldata", "1");
+
+    // Debugging
+    this->Opt->AddDefaultMap("validatemesh", "0");
+
     // Input/output
     if ( !this->Opt->has_key("output") ) {
         std :: string inputname = this->Opt->GiveStringValue("input");
@@ -87,6 +113,8 @@ void Voxel2TetClass :: PrintHelp()
     printf("\n\t\t-exportsteps      \tExport the result of each step in VTK format (mainly for debugging purposes)");
     printf("\n\t\t-datacontainer name\t(Dream3D input) Name of data group, default 'VoxelDataContainer'");
     printf("\n\t\t-materialid name  \t(Dream3D input) Field containing an identifier for the phase, default 'GrainIds'");
+    printf("\n\t\t-releasevoxeldata \tRelease the voxel data as soon as surfaces and edges are found, default 1");
+    printf("\n\t\t-validatemesh     \tValidate the connectivity of the mesh between each step");
     printf("\n\t\t-voxelcutout arg) \tOnly consider the subset of the input contained within the boundingbox defined by arg. Here, arg=\"[xmin ymin zmin xmax ymax zmax]\" (include citations and brackets)");
 
 
@@ -148,6 +176,37 @@ void Voxel2TetClass :: LoadFile(std :: string Filename)
     FinalizeLoad();
 }
 
+Smoother *Voxel2TetClass :: CreateSmoother(std :: string Prefix, double VoxelCharLength)
+{
+    std :: string Name = this->Opt->GiveStringValue(Prefix + "smoother");
+
+    if ( Name == "taubin" ) {
+        return new TaubinSmoother( Opt->GiveDoubleValue("taubin_lambda"), Opt->GiveDoubleValue("taubin_mu"), Opt->GiveIntegerValue("taubin_iterations") );
+    } else if ( Name == "laplacian" ) {
+        return new LaplacianSmoother( VoxelCharLength, Opt->GiveDoubleValue("laplacian_limit_factor"), Opt->GiveIntegerValue("laplacian_maxiter") );
+    } else if ( ( Name == "sdf" ) & ( Prefix == "" ) ) {
+        return new SignedDistanceSmoother( this->Imp, Opt->GiveDoubleValue("sdf_sigma"), Opt->GiveIntegerValue("sdf_passes") );
+    } else if ( Name != "spring" ) {
+        STATUS("Smoother '%s' is not available for %s\n", Name.c_str(), ( Prefix == "" ) ? "surfaces" : "edges");
+        throw( 0 );
+    }
+
+    SpringSmoother *NewSmoother;
+    if ( this->Opt->has_key(Prefix + "spring_c") ) {
+        NewSmoother = new SpringSmoother(VoxelCharLength, Opt->GiveDoubleValue(Prefix + "spring_c"), Opt->GiveDoubleValue(Prefix + "spring_alpha"), Opt->GiveDoubleValue(Prefix + "spring_c_factor"), false );
+    } else {
+        NewSmoother = new SpringSmoother(VoxelCharLength, Opt->GiveDoubleValue(Prefix + "spring_c"), Opt->GiveDoubleValue(Prefix + "spring_alpha"), Opt->GiveDoubleValue(Prefix + "spring_c_factor"), true );
+    }
+
+    NewSmoother->GaussSeidel = this->Opt->GiveBooleanValue("spring_gaussseidel");
+    NewSmoother->Global = this->Opt->GiveBooleanValue("spring_global");
+    NewSmoother->Multilevel = this->Opt->GiveBooleanValue("spring_multilevel");
+    NewSmoother->AndersonDepth = this->Opt->GiveIntegerValue("spring_anderson");
+    NewSmoother->ActiveSet = this->Opt->GiveBooleanValue("spring_activeset");
+
+    return NewSmoother;
+}
+
 void Voxel2TetClass :: FinalizeLoad()
 {
 
@@ -160,17 +219,8 @@ void Voxel2TetClass :: FinalizeLoad()
     STATUS("\tNumber of voxels are %u * %u * %u = %u\n", dim [ 0 ], dim [ 1 ], dim [ 2 ], dim [ 0 ] * dim [ 1 ] * dim [ 2 ]);
 
     // Setup smoothing classes
-    if ( this->Opt->has_key("spring_c") ) {
-        this->SurfaceSmoother = new SpringSmoother(cellspace[0], Opt->GiveDoubleValue("spring_c"), Opt->GiveDoubleValue("spring_alpha"), Opt->GiveDoubleValue("spring_c_factor"), false );
-    } else {
-        this->SurfaceSmoother = new SpringSmoother(cellspace[0], Opt->GiveDoubleValue("spring_c"), Opt->GiveDoubleValue("spring_alpha"), Opt->GiveDoubleValue("spring_c_factor"), true );
-    }
-
-    if ( this->Opt->has_key("edge_spring_c") ) {
-        this->EdgeSmoother = new SpringSmoother(cellspace[0], Opt->GiveDoubleValue("edge_spring_c"), Opt->GiveDoubleValue("edge_spring_alpha"), Opt->GiveDoubleValue("edge_spring_c_factor"), false );
-    } else {
-        this->EdgeSmoother = new SpringSmoother(cellspace[0], Opt->GiveDoubleValue("edge_spring_c"), Opt->GiveDoubleValue("edge_spring_alpha"), Opt->GiveDoubleValue("edge_spring_c_factor"), true );
-    }
+    this->SurfaceSmoother = this->CreateSmoother("", cellspace [ 0 ]);
+    this->EdgeSmoother = this->CreateSmoother("edge_", cellspace [ 0 ]);
 
     // Setup bounding box
     BoundingBoxType bb;
@@ -226,6 +276,7 @@ void Voxel2TetClass :: FinalizeLoad()
 
     // Create mesh managing object
     Mesh = new MeshManipulations(bb);
+    Mesh->VertexGrid->SetCellSize({ { cellspace [ 0 ], cellspace [ 1 ], cellspace [ 2 ] } });
 
 
     this->Mesh->TOL_COL_MAXVOLUMECHANGE = cellspace [ 0 ] * cellspace [ 1 ] * cellspace [ 2 ] * 2;
@@ -243,6 +294,31 @@ void Voxel2TetClass :: UpdateSurfaces()
     }
 }
 
+void Voxel2TetClass :: ReorderMesh()
+{
+    this->Mesh->ReorderMesh();
+
+    for ( Surface *s : this->Surfaces ) {
+        std :: sort( s->Vertices.begin(), s->Vertices.end(), [](VertexType *a, VertexType *b) {
+            return a->ID < b->ID;
+        });
+    }
+
+    this->UpdateSurfaces();
+}
+
+void Voxel2TetClass :: ValidateMesh(std :: string StepName)
+{
+    if ( !this->Opt->GiveBooleanValue("validatemesh") ) {
+        return;
+    }
+
+    STATUS( "Validate mesh after %s\n", StepName.c_str() );
+    if ( !this->Mesh->ValidateMesh() ) {
+        throw( 0 );
+    }
+}
+
 void Voxel2TetClass :: ExportSurface(std :: string FileName, Exporter_FileTypes FileType)
 {
     this->Mesh->ExportSurface(FileName, FileType);
@@ -389,7 +465,7 @@ void Voxel2TetClass :: FindSurfaces()
                                 newvertex [ vindex.at(m).at(0) ] = newvertex [ vindex.at(m).at(0) ] + s1 * delta [ vindex.at(m) [ 0 ] ];
                                 newvertex [ vindex.at(m).at(1) ] = newvertex [ vindex.at(m).at(1) ] + s2 * delta [ vindex.at(m) [ 1 ] ];
 
-                                int id = Mesh->VertexOctreeRoot->AddVertex(newvertex [ 0 ], newvertex [ 1 ], newvertex [ 2 ]);
+                                int id = Mesh->VertexGrid->AddVertex(newvertex [ 0 ], newvertex [ 1 ], newvertex [ 2 ]);
                                 LOG("Corner (id=%u) at (%f, %f, %f)\n", id, newvertex [ 0 ], newvertex [ 1 ], newvertex [ 2 ]);
                                 VoxelIDs.push_back(id);
                             }
@@ -519,7 +595,7 @@ void Voxel2TetClass :: FindEdges()
             for ( int j = 0; j < 3; j++ ) {
                 c [ j ] = v->get_c(j) + testdirections.at(i).at(j) * spacing [ j ];
             }
-            VertexType *Neighbour = this->Mesh->VertexOctreeRoot->FindVertexByCoords(c [ 0 ], c [ 1 ], c [ 2 ]);
+            VertexType *Neighbour = this->Mesh->VertexGrid->FindVertexByCoords(c [ 0 ], c [ 1 ], c [ 2 ]);
 
             if ( std :: find(EdgeVertices.begin(), EdgeVertices.end(), Neighbour) != EdgeVertices.end() ) {
                 LOG("Found Neightbour %p for %p\n", Neighbour, v);
@@ -669,115 +745,108 @@ void Voxel2TetClass :: SmoothEdgesIndividually()
     }
 }
 
-void Voxel2TetClass :: SmoothEdgesSimultaneously()
+std :: vector< VertexType * >Voxel2TetClass :: PrepareEdgeVertices()
 {
-
-    //TODO: This does far too much stuff. A lot of thing has moved to the Smoother class. Clean this up.
-    STATUS("Smooth edges (simultaneously)\n", 0);
-
-    // We want to sort several lists according to one list. (http://stackoverflow.com/questions/1723066/c-stl-custom-sorting-one-vector-based-on-contents-of-another)
-    struct VertexConnectivity {
-        VertexType *v;
-        std :: vector< VertexType * >Connections;
-        std :: array< bool, 3 >FixedDirections;
-    };
-
-    struct by_vertexptr {
-        bool operator()(VertexConnectivity *a, VertexConnectivity *b) { return ( a->v < b->v ); }
-    };
-
-    std :: vector< VertexConnectivity * >VertexConnections;
-
-    // Collect all vertices on phase edges
-    int j = 0;
+    // Collect all vertices on phase edges. Vertices shared by several phase edges appear once.
+    std :: vector< VertexType * >VertexList;
     for ( PhaseEdge *p : this->PhaseEdges ) {
-        std :: vector< std :: vector< VertexType * > >Connections;
-        std :: vector< std :: array< bool, 3 > >FixedDirectionsList;
-
         std :: vector< VertexType * >EdgeVertices = p->GetFlatListOfVertices();
-        p->GiveTopologyLists(& Connections, & FixedDirectionsList);
-
-        for ( unsigned int i = 0; i < EdgeVertices.size(); i++ ) {
-            VertexType *v = EdgeVertices.at(i);
-            VertexConnectivity *vc = new VertexConnectivity;
-            vc->v = v;
-            vc->Connections.insert( vc->Connections.begin(), Connections.at(i).begin(), Connections.at(i).end() );
-            vc->FixedDirections = FixedDirectionsList.at(i);
-            VertexConnections.push_back(vc);
-        }
-        j++;
+        VertexList.insert( VertexList.end(), EdgeVertices.begin(), EdgeVertices.end() );
     }
+    std :: sort( VertexList.begin(), VertexList.end() );
+    VertexList.erase( std :: unique( VertexList.begin(), VertexList.end() ), VertexList.end() );
 
-    // Sort list by VertexType address and merge information of duplicate vertices
-    std :: sort( VertexConnections.begin(), VertexConnections.end(), by_vertexptr() );
-
-    unsigned int i = 0;
-    while ( i < VertexConnections.size() ) {
-        // Compare element i to element i+1. If the elements points to the same vertex, merge connections and remove element i+1
-        if ( i < ( VertexConnections.size() - 1 ) ) {
-            if ( VertexConnections.at(i)->v == VertexConnections.at(i + 1)->v ) {
-                VertexConnectivity *thisvc = VertexConnections.at(i);
-                VertexConnectivity *nextvc = VertexConnections.at(i + 1);
-
-                thisvc->Connections.insert( thisvc->Connections.end(), nextvc->Connections.begin(), nextvc->Connections.end() );
-
-                // Uniqueify connections
-                std :: sort( thisvc->Connections.begin(), thisvc->Connections.end() );
-                std :: vector< VertexType * > :: iterator it;
-                it = std :: unique( thisvc->Connections.begin(), thisvc->Connections.end() );
-                if ( it != thisvc->Connections.end() ) {
-                    thisvc->Connections.erase(it);
-                }
-
-                // Erase next connection
-                VertexConnections.erase(VertexConnections.begin() + i + 1);
-            } else {
-                i++;
-            }
-        } else {
-            i++;
+    // Vertices on the boundary of the domain are locked in the normal direction of the boundary. The tolerance is relative
+    // to the voxel size since stored coordinates may be rounded to single precision.
+    BoundingBoxType BoundingBox = this->Imp->GiveBoundingBox();
+    double Spacing [ 3 ];
+    this->Imp->GiveSpacing(Spacing);
+    for ( VertexType *v : VertexList ) {
+        for ( int j = 0; j < 3; j++ ) {
+            double Tolerance = 1e-3 * Spacing [ j ];
+            v->Fixed [ j ] = ( v->get_c(j) > ( BoundingBox.maxvalues [ j ] - Tolerance ) ) | ( v->get_c(j) < ( BoundingBox.minvalues [ j ] + Tolerance ) );
         }
     }
 
-    // Build connectivity and FixedDirectionsLists
-    std :: vector< VertexType * >VertexList;
-    std :: vector< std :: vector< VertexType * > >Connections;
-    std :: vector< bool >FixedDirectionsList;
+    return VertexList;
+}
 
-    for ( unsigned int i = 0; i < VertexConnections.size(); i++ ) {
-        VertexType *v = VertexConnections.at(i)->v;
+void Voxel2TetClass :: SmoothEdgesSimultaneously()
+{
+    STATUS("Smooth edges (simultaneously)\n", 0);
 
-        VertexList.push_back(v);
-        Connections.push_back(VertexConnections.at(i)->Connections);
+    // The connectivity is built by the smoother
+    std :: vector< VertexType * >VertexList = this->PrepareEdgeVertices();
+    this->EdgeSmoother->Smooth(VertexList, this->Mesh);
+}
 
-        // Determine which directions are locked TODO: This should be done elsewhere
-        for ( int j = 0; j < 3; j++ ) {
-            if ( ( v->get_c(j) > ( this->Imp->GiveBoundingBox().maxvalues [ j ] - eps ) ) | ( v->get_c(j) < ( this->Imp->GiveBoundingBox().minvalues [ j ] + eps ) ) ) {
-                v->Fixed [ j ] = true;
-            } else {
-                v->Fixed [ j ] = false;
-            }
+void Voxel2TetClass :: SmoothEdgesInParallel()
+{
+    STATUS("Smooth edges (in parallel)\n", 0);
+
+    this->PrepareEdgeVertices();
+
+    // A vertex on a phase edge is only connected to vertices on the same phase edge, and vertices on several phase edges
+    // are fixed. Thus, each phase edge is an independent problem. The fixed vertices are shared by several phase edges and
+    // are left out, such that each vertex is written by one call to Smooth only. Start with the longest phase edges for
+    // better load balance. The check for intersecting triangles is deferred until all phase edges are smoothed, such that
+    // the result does not depend on the order in which the phase edges finish.
+    std :: vector< std :: vector< VertexType * > >EdgeVertexLists;
+    for ( PhaseEdge *p : this->PhaseEdges ) {
+        if ( p->EdgeSegments.size() == 1 ) {
+            continue;
+        }
+        std :: vector< VertexType * >EdgeVertices = p->GetFlatListOfVertices();
+        EdgeVertices.erase( std :: remove_if( EdgeVertices.begin(), EdgeVertices.end(), [](VertexType * v) {
+                                                  return v->IsFixedVertex();
+                                              } ), EdgeVertices.end() );
+        if ( EdgeVertices.size() > 0 ) {
+            EdgeVertexLists.push_back(EdgeVertices);
         }
-        FixedDirectionsList.push_back(false);
     }
+    std :: stable_sort( EdgeVertexLists.begin(), EdgeVertexLists.end(), [](const std :: vector< VertexType * > &a, const std :: vector< VertexType * > &b) {
+                            return a.size() > b.size();
+                        });
 
-    for ( VertexConnectivity *v : VertexConnections ) {
-        delete v;
+    this->EdgeSmoother->DeferRepair = true;
+    bool succeeded = ParallelFor(0, EdgeVertexLists.size(), true, [ & ](int i) {
+                                     this->EdgeSmoother->Smooth(EdgeVertexLists [ i ], this->Mesh);
+                                 });
+    this->EdgeSmoother->DeferRepair = false;
+
+    if ( !succeeded ) {
+        STATUS("Failed to smooth edges\n", 0);
+        throw( 0 );
     }
 
-    this->EdgeSmoother->Smooth(VertexList, this->Mesh);
+    this->EdgeSmoother->RepairDeferred(this->Mesh);
 }
 
 void Voxel2TetClass :: SmoothSurfaces()
 {
     STATUS("Smooth surfaces\n", 0);
 
-    int i = 1;
-    for ( Surface *s : this->Surfaces ) {
-        STATUS( "Smoothing surface %i (%i)\n", i, this->Surfaces.size() );
-        s->Smooth(this->Mesh);
-        i++;
+    // Vertices on phase edges are not smoothed here, thus no vertex is smoothed as part of more than one surface and the
+    // surfaces can be smoothed concurrently. Start with the largest surfaces for better load balance. Repairing
+    // intersecting triangles moves vertices of other surfaces, thus it is deferred until all surfaces are smoothed.
+    std :: vector< Surface * >SortedSurfaces = this->Surfaces;
+    std :: stable_sort( SortedSurfaces.begin(), SortedSurfaces.end(), [](Surface * a, Surface * b) {
+                            return a->Vertices.size() > b->Vertices.size();
+                        });
+
+    this->SurfaceSmoother->DeferRepair = true;
+    bool succeeded = ParallelFor(0, SortedSurfaces.size(), true, [ & ](int i) {
+                                     STATUS( "Smoothing surface %i (%zu)\n", i + 1, SortedSurfaces.size() );
+                                     SortedSurfaces [ i ]->Smooth(this->Mesh);
+                                 });
+    this->SurfaceSmoother->DeferRepair = false;
+
+    if ( !succeeded ) {
+        STATUS("Failed to smooth surfaces\n", 0);
+        throw( 0 );
     }
+
+    this->SurfaceSmoother->RepairDeferred(this->Mesh);
 }
 
 void Voxel2TetClass :: SmoothAllAtOnce()
@@ -936,6 +1005,7 @@ void Voxel2TetClass :: Process()
     Timer.StartTimer("Find surfaces");
     this->FindSurfaces();
     Timer.StopTimer();
+    this->ValidateMesh("finding surfaces");
 
     // Compute volumes enclosed by surfaces
     Timer.StartTimer("Compute volumes");
@@ -947,20 +1017,37 @@ void Voxel2TetClass :: Process()
     Timer.StopTimer();
 
     if ( this->Opt->GiveBooleanValue("exportsteps") ) {
-        this->Mesh->ExportSurface(strfmt("%s_step_%u.simple", this->Opt->GiveStringValue("output").c_str(), outputindex), FT_SIMPLE);
-        this->Mesh->ExportSurface(strfmt("%s_step_%u.vtp", this->Opt->GiveStringValue("output").c_str(), outputindex++), FT_VTK);
+        MeshSnapshot *Snapshot = this->Mesh->CreateSnapshot();
+        this->Mesh->ExportSurface(strfmt("%s_step_%u.simple", this->Opt->GiveStringValue("output").c_str(), outputindex), FT_SIMPLE, Snapshot);
+        this->Mesh->ExportSurface(strfmt("%s_step_%u.vtp", this->Opt->GiveStringValue("output").c_str(), outputindex++), FT_VTK, Snapshot);
+        delete Snapshot;
     }
 
     Timer.StartTimer("Find edges");
     this->FindEdges();
     Timer.StopTimer();
+    this->ValidateMesh("finding edges");
+
+    // The voxel data is not needed once the topology is known, unless the surfaces are smoothed using the voxel data
+    if ( this->Opt->GiveBooleanValue("releasevoxeldata") & ( this->Opt->GiveStringValue("smoother") != "sdf" ) ) {
+        this->Imp->ReleaseData();
+    }
+
+    Timer.StartTimer("Reorder mesh");
+    this->ReorderMesh();
+    Timer.StopTimer();
 
     Timer.StartTimer("Smooth edges");
     double Spacing [ 3 ];
     this->Imp->GiveSpacing(Spacing);
 
-    this->SmoothEdgesSimultaneously();
+    if ( this->Opt->GiveBooleanValue("edge_parallel") ) {
+        this->SmoothEdgesInParallel();
+    } else {
+        this->SmoothEdgesSimultaneously();
+    }
     Timer.StopTimer();
+    this->ValidateMesh("smoothing edges");
 
 #if TEST_MESH_BETWEEN_STEPS_TETGEN == 1
     TetGenCaller Generator;
@@ -972,13 +1059,16 @@ void Voxel2TetClass :: Process()
     PhaseVolumes.push_back(CurrentVolumes);
 
     if ( this->Opt->GiveBooleanValue("exportsteps") ) {
-        this->Mesh->ExportSurface(strfmt("%s_step_%u.simple", this->Opt->GiveStringValue("output").c_str(), outputindex), FT_SIMPLE);
-        this->Mesh->ExportSurface(strfmt("%s_step_%u.vtp", this->Opt->GiveStringValue("output").c_str(), outputindex++), FT_VTK);
+        MeshSnapshot *Snapshot = this->Mesh->CreateSnapshot();
+        this->Mesh->ExportSurface(strfmt("%s_step_%u.simple", this->Opt->GiveStringValue("output").c_str(), outputindex), FT_SIMPLE, Snapshot);
+        this->Mesh->ExportSurface(strfmt("%s_step_%u.vtp", this->Opt->GiveStringValue("output").c_str(), outputindex++), FT_VTK, Snapshot);
+        delete Snapshot;
     }
 
     Timer.StartTimer("Smooth surfaces");
     this->SmoothSurfaces();
     Timer.StopTimer();
+    this->ValidateMesh("smoothing surfaces");
 
 #if TEST_MESH_BETWEEN_STEPS_TETGEN == 1
     Generator.TestMesh();
@@ -988,8 +1078,10 @@ void Voxel2TetClass :: Process()
     PhaseVolumes.push_back(CurrentVolumes);
 
     if ( this->Opt->GiveBooleanValue("exportsteps") ) {
-        this->Mesh->ExportSurface(strfmt("%s_step_%u.simple", this->Opt->GiveStringValue("output").c_str(), outputindex), FT_SIMPLE);
-        this->Mesh->ExportSurface(strfmt("%s_step_%u.vtp", this->Opt->GiveStringValue("output").c_str(), outputindex++), FT_VTK);
+        MeshSnapshot *Snapshot = this->Mesh->CreateSnapshot();
+        this->Mesh->ExportSurface(strfmt("%s_step_%u.simple", this->Opt->GiveStringValue("output").c_str(), outputindex), FT_SIMPLE, Snapshot);
+        this->Mesh->ExportSurface(strfmt("%s_step_%u.vtp", this->Opt->GiveStringValue("output").c_str(), outputindex++), FT_VTK, Snapshot);
+        delete Snapshot;
     }
 
     //this->Mesh->DoSanityCheck();
@@ -997,18 +1089,33 @@ void Voxel2TetClass :: Process()
     //this->Mesh->DoSanityCheck();
 
     this->UpdateSurfaces();
+    this->ValidateMesh("flipping edges");
 
     GetListOfVolumes(CurrentVolumes, PhaseList);
     PhaseVolumes.push_back(CurrentVolumes);
 
     if ( this->Opt->GiveBooleanValue("exportsteps") ) {
-        this->Mesh->ExportSurface(strfmt("%s_step_%u.simple", this->Opt->GiveStringValue("output").c_str(), outputindex), FT_SIMPLE);
-        this->Mesh->ExportSurface(strfmt("%s_step_%u.vtp", this->Opt->GiveStringValue("output").c_str(), outputindex++), FT_VTK);
+        MeshSnapshot *Snapshot = this->Mesh->CreateSnapshot();
+        this->Mesh->ExportSurface(strfmt("%s_step_%u.simple", this->Opt->GiveStringValue("output").c_str(), outputindex), FT_SIMPLE, Snapshot);
+        this->Mesh->ExportSurface(strfmt("%s_step_%u.vtp", this->Opt->GiveStringValue("output").c_str(), outputindex++), FT_VTK, Snapshot);
+        delete Snapshot;
+    }
+
+    Timer.StartTimer("Reorder mesh");
+    this->ReorderMesh();
+    Timer.StopTimer();
+
+    if ( this->Opt->GiveBooleanValue("edge_simplify") ) {
+        Timer.StartTimer("Simplify edges");
+        this->Mesh->SimplifyPhaseEdges( this->PhaseEdges, this->Opt->GiveDoubleValue("edge_simplify_tolerance") * Spacing [ 0 ] );
+        Timer.StopTimer();
+        this->ValidateMesh("simplifying edges");
     }
 
     Timer.StartTimer("Coarsen mesh");
     this->Mesh->CoarsenMesh();
     Timer.StopTimer();
+    this->ValidateMesh("coarsening mesh");
 
     this->UpdateSurfaces();
 
@@ -1016,18 +1123,23 @@ void Voxel2TetClass :: Process()
     PhaseVolumes.push_back(CurrentVolumes);
 
     if ( this->Opt->GiveBooleanValue("exportsteps") ) {
-        this->Mesh->ExportSurface(strfmt("%s_step_%u.simple", this->Opt->GiveStringValue("output").c_str(), outputindex), FT_SIMPLE);
-        this->Mesh->ExportSurface(strfmt("%s_step_%u.vtp", this->Opt->GiveStringValue("output").c_str(), outputindex++), FT_VTK);
+        MeshSnapshot *Snapshot = this->Mesh->CreateSnapshot();
+        this->Mesh->ExportSurface(strfmt("%s_step_%u.simple", this->Opt->GiveStringValue("output").c_str(), outputindex), FT_SIMPLE, Snapshot);
+        this->Mesh->ExportSurface(strfmt("%s_step_%u.vtp", this->Opt->GiveStringValue("output").c_str(), outputindex++), FT_VTK, Snapshot);
+        delete Snapshot;
     }
     this->Mesh->FlipAll();
     this->UpdateSurfaces();
+    this->ValidateMesh("final flipping of edges");
 
     GetListOfVolumes(CurrentVolumes, PhaseList);
     PhaseVolumes.push_back(CurrentVolumes);
 
     if ( this->Opt->GiveBooleanValue("exportsteps") ) {
-        this->Mesh->ExportSurface(strfmt("%s_step_%u.simple", this->Opt->GiveStringValue("output").c_str(), outputindex), FT_SIMPLE);
-        this->Mesh->ExportSurface(strfmt("%s_step_%u.vtp", this->Opt->GiveStringValue("output").c_str(), outputindex++), FT_VTK);
+        MeshSnapshot *Snapshot = this->Mesh->CreateSnapshot();
+        this->Mesh->ExportSurface(strfmt("%s_step_%u.simple", this->Opt->GiveStringValue("output").c_str(), outputindex), FT_SIMPLE, Snapshot);
+        this->Mesh->ExportSurface(strfmt("%s_step_%u.vtp", this->Opt->GiveStringValue("output").c_str(), outputindex++), FT_VTK, Snapshot);
+        delete Snapshot;
     }
 
     for ( int p : PhaseList ) {
@@ -1050,31 +1162,40 @@ void Voxel2TetClass :: Process()
 
 void Voxel2TetClass :: ExportAllSurfaces()
 {
+    // All files are written from the same snapshot of the mesh
+    MeshSnapshot *Snapshot = this->Mesh->CreateSnapshot();
+
     // Surfaces
     if ( this->Opt->GiveBooleanValue("exportvtksurface") ) {
-        this->Mesh->ExportSurface(strfmt( "%s.surface.vtp", this->Opt->GiveStringValue("output").c_str() ), FT_VTK);
+        this->Mesh->ExportSurface(strfmt( "%s.surface.vtp", this->Opt->GiveStringValue("output").c_str() ), FT_VTK, Snapshot);
     }
 
     if ( this->Opt->GiveBooleanValue("exportoff") ) {
-        this->Mesh->ExportSurface(strfmt( "%s.surface.off", this->Opt->GiveStringValue("output").c_str() ), FT_OFF);
+        this->Mesh->ExportSurface(strfmt( "%s.surface.off", this->Opt->GiveStringValue("output").c_str() ), FT_OFF, Snapshot);
     }
+
+    delete Snapshot;
 }
 
 void Voxel2TetClass :: ExportAllVolumes()
 {
+    MeshSnapshot *Snapshot = this->Mesh->CreateSnapshot();
+
     // Volumes
     if ( this->Opt->GiveBooleanValue("exportvtkvolume") ) {
-        this->Mesh->ExportVolume(strfmt( "%s.volume_0.vtu", this->Opt->GiveStringValue("output").c_str() ), FT_VTK);
-        this->Mesh->ExportVolume(strfmt( "%s.volume_1.vtu", this->Opt->GiveStringValue("output").c_str() ), FT_VTK);
+        this->Mesh->ExportVolume(strfmt( "%s.volume_0.vtu", this->Opt->GiveStringValue("output").c_str() ), FT_VTK, Snapshot);
+        this->Mesh->ExportVolume(strfmt( "%s.volume_1.vtu", this->Opt->GiveStringValue("output").c_str() ), FT_VTK, Snapshot);
     }
 
     if ( this->Opt->GiveBooleanValue("exportoofem") ) {
-        this->Mesh->ExportVolume(strfmt( "%s.in", this->Opt->GiveStringValue("output").c_str() ), FT_OOFEM);
+        this->Mesh->ExportVolume(strfmt( "%s.in", this->Opt->GiveStringValue("output").c_str() ), FT_OOFEM, Snapshot);
     }
 
     if ( this->Opt->GiveBooleanValue("exportabaqus") ) {
-        this->Mesh->ExportVolume(strfmt( "%s.inp", this->Opt->GiveStringValue("output").c_str() ), FT_ABAQUS);
+        this->Mesh->ExportVolume(strfmt( "%s.inp", this->Opt->GiveStringValue("output").c_str() ), FT_ABAQUS, Snapshot);
     }
+
+    delete Snapshot;
 }
 
 void Voxel2TetClass :: ExportStatistics()
@@ -1097,6 +1218,11 @@ void Voxel2TetClass :: ExportStatistics()
     StatFile << "\tOrigin:     " << origin [ 0 ] << "*" << origin [ 1 ] << "*" << origin [ 2 ] << "\n";
     StatFile << "\tSpacing:    " << spacing [ 0 ] << "*" << spacing [ 1 ] << "*" << spacing [ 2 ] << "\n";
     StatFile << "Output file:\t" << this->Opt->GiveStringValue("output") << "\n";
+#ifdef SINGLE_PRECISION
+    StatFile << "Coordinate storage:\tsingle precision\n";
+#else
+    StatFile << "Coordinate storage:\tdouble precision\n";
+#endif
 
     StatFile << "\nConstants used during smoothing\n";
     StatFile <<   "-------------------------------\n";
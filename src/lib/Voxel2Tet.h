@@ -40,6 +40,11 @@ private:
 
     void SmoothEdgesIndividually();
     void SmoothEdgesSimultaneously();
+    void SmoothEdgesInParallel();
+
+    // Gives all vertices on phase edges, without duplicates, and locks those on the boundary of the domain in the normal
+    // direction of the boundary
+    std :: vector< VertexType * >PrepareEdgeVertices();
     void SmoothSurfaces();
     void SmoothAllAtOnce();
 
@@ -53,6 +58,12 @@ private:
 
     void UpdateSurfaces();
 
+    // Reorders the mesh along a space filling curve and updates the surfaces to the new order
+    void ReorderMesh();
+
+    // Validates the mesh if requested by the 'validatemesh' option. Throws an exception if the mesh is invalid.
+    void ValidateMesh(std :: string StepName);
+
     double eps = 1e-6;
 
     TimeStamp Timer;
@@ -61,8 +72,12 @@ private:
     std :: vector< double >CurrentVolumes;
     std :: vector< int >PhaseList;
 
-    SpringSmoother *SurfaceSmoother;
-    SpringSmoother *EdgeSmoother;
+    Smoother *SurfaceSmoother;
+    Smoother *EdgeSmoother;
+
+    // Creates the smoother selected by the option Prefix+"smoother", i.e. 'smoother' for surfaces and 'edge_smoother' for
+    // phase edges
+    Smoother *CreateSmoother(std :: string Prefix, double VoxelCharLength);
 
 public:
 